@@ -0,0 +1,102 @@
+#include "datagram_pool.h"
+
+DatagramBuffer::DatagramBuffer(const DatagramBuffer& other) : pool_(other.pool_), index_(other.index_) {
+    if (pool_) {
+        pool_->slots_[index_].ref_count++;
+    }
+}
+
+DatagramBuffer::DatagramBuffer(DatagramBuffer&& other) noexcept : pool_(std::move(other.pool_)), index_(other.index_) {
+    other.index_ = -1;
+}
+
+DatagramBuffer& DatagramBuffer::operator=(const DatagramBuffer& other) {
+    if (this != &other) {
+        Release();
+        pool_ = other.pool_;
+        index_ = other.index_;
+        if (pool_) {
+            pool_->slots_[index_].ref_count++;
+        }
+    }
+    return *this;
+}
+
+DatagramBuffer& DatagramBuffer::operator=(DatagramBuffer&& other) noexcept {
+    if (this != &other) {
+        Release();
+        pool_ = std::move(other.pool_);
+        index_ = other.index_;
+        other.index_ = -1;
+    }
+    return *this;
+}
+
+char* DatagramBuffer::data() const {
+    return pool_ ? pool_->storage_.data() + index_ * pool_->buffer_size_ : nullptr;
+}
+
+size_t DatagramBuffer::size() const {
+    return pool_ ? pool_->slots_[index_].size : 0;
+}
+
+size_t DatagramBuffer::capacity() const {
+    return pool_ ? pool_->buffer_size_ : 0;
+}
+
+void DatagramBuffer::set_size(size_t size) {
+    if (pool_) {
+        pool_->slots_[index_].size = size < pool_->buffer_size_ ? size : pool_->buffer_size_;
+    }
+}
+
+void DatagramBuffer::Release() {
+    if (!pool_) {
+        return;
+    }
+    if (--pool_->slots_[index_].ref_count == 0) {
+        pool_->Return(index_);
+    }
+    pool_.reset();
+    index_ = -1;
+}
+
+std::shared_ptr<DatagramPool> DatagramPool::Create(size_t count, size_t buffer_size) {
+    return std::shared_ptr<DatagramPool>(new DatagramPool(count, buffer_size));
+}
+
+DatagramPool::DatagramPool(size_t count, size_t buffer_size)
+    : buffer_size_(buffer_size), storage_(count * buffer_size), slots_(new Slot[count]) {
+    free_slots_.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        slots_[i].ref_count = 0;
+        slots_[i].size = 0;
+        free_slots_.push_back(count - 1 - i);
+    }
+}
+
+DatagramBuffer DatagramPool::Acquire() {
+    int index;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_slots_.empty()) {
+            exhausted_count_++;
+            return DatagramBuffer();
+        }
+        index = free_slots_.back();
+        free_slots_.pop_back();
+    }
+    slots_[index].ref_count = 1;
+    slots_[index].size = 0;
+    return DatagramBuffer(shared_from_this(), index);
+}
+
+size_t DatagramPool::available() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_slots_.size();
+}
+
+void DatagramPool::Return(int index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_slots_.push_back(index);
+}
@@ -0,0 +1,207 @@
+#include "dns_cache.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <cstring>
+
+static const char *TAG = "DnsCache";
+
+void DnsCache::SetTtl(int ttl_seconds, int negative_ttl_seconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ttl_us_ = ttl_seconds * 1000000LL;
+    negative_ttl_us_ = negative_ttl_seconds * 1000000LL;
+}
+
+bool DnsCache::ParseLiteral(const std::string& host, std::vector<struct sockaddr_storage>& addrs) {
+    struct sockaddr_storage storage = {};
+    auto addr4 = (struct sockaddr_in*)&storage;
+    auto addr6 = (struct sockaddr_in6*)&storage;
+    if (inet_pton(AF_INET, host.c_str(), &addr4->sin_addr) == 1) {
+        addr4->sin_family = AF_INET;
+    } else if (inet_pton(AF_INET6, host.c_str(), &addr6->sin6_addr) == 1) {
+        addr6->sin6_family = AF_INET6;
+    } else {
+        return false;
+    }
+    addrs.assign(1, storage);
+    return true;
+}
+
+bool DnsCache::Resolve(const std::string& host, struct in_addr& addr) {
+    std::vector<struct sockaddr_storage> addrs;
+    if (!Resolve(host, addrs)) {
+        return false;
+    }
+    for (auto& storage : addrs) {
+        if (storage.ss_family == AF_INET) {
+            addr = ((struct sockaddr_in*)&storage)->sin_addr;
+            return true;
+        }
+    }
+    ESP_LOGE(TAG, "No IPv4 address for %s", host.c_str());
+    return false;
+}
+
+bool DnsCache::Resolve(const std::string& host, std::vector<struct sockaddr_storage>& addrs) {
+    if (ParseLiteral(host, addrs)) {
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        int64_t now = esp_timer_get_time();
+        auto it = entries_.find(host);
+        if (it == entries_.end()) {
+            break;
+        }
+        auto& entry = it->second;
+        if (now < entry.expire_at_us) {
+            if (!entry.valid) {
+                stats_.negative_hits++;
+                return false;
+            }
+            stats_.hits++;
+            addrs = entry.addrs;
+            // 快过期时后台刷新
+            int64_t lifetime = entry.expire_at_us - entry.resolved_at_us;
+            if (!entry.resolving && entry.expire_at_us - now < lifetime * DNS_CACHE_REFRESH_PERCENT / 100) {
+                entry.resolving = true;
+                lock.unlock();
+                StartPrefetch(host);
+            }
+            return true;
+        }
+        if (!entry.resolving) {
+            break;
+        }
+        // 其他任务正在解析同一主机，等待其结果
+        cv_.wait(lock);
+    }
+
+    stats_.misses++;
+    entries_[host].resolving = true;
+    lock.unlock();
+    return Lookup(host, addrs);
+}
+
+bool DnsCache::Lookup(const std::string& host, std::vector<struct sockaddr_storage>& addrs) {
+    int64_t start = esp_timer_get_time();
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    // 只取一种 socktype，避免同一地址按 TCP/UDP 各返回一次
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* result = nullptr;
+    int ret = getaddrinfo(host.c_str(), nullptr, &hints, &result);
+    addrs.clear();
+    for (auto ai = ret == 0 ? result : nullptr; ai != nullptr; ai = ai->ai_next) {
+        if ((ai->ai_family != AF_INET && ai->ai_family != AF_INET6) || ai->ai_addrlen > sizeof(struct sockaddr_storage)) {
+            continue;
+        }
+        struct sockaddr_storage storage = {};
+        memcpy(&storage, ai->ai_addr, ai->ai_addrlen);
+        addrs.push_back(storage);
+    }
+    bool ok = !addrs.empty();
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to resolve %s: %d", host.c_str(), ret);
+    }
+    if (result != nullptr) {
+        freeaddrinfo(result);
+    }
+    Update(host, ok, addrs, esp_timer_get_time() - start);
+    return ok;
+}
+
+void DnsCache::Update(const std::string& host, bool ok, const std::vector<struct sockaddr_storage>& addrs, int64_t resolve_us) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        int64_t now = esp_timer_get_time();
+        auto& entry = entries_[host];
+        entry.resolving = false;
+        stats_.last_resolve_us = resolve_us;
+        if (ok) {
+            entry.addrs = addrs;
+            entry.valid = true;
+            entry.resolved_at_us = now;
+            entry.expire_at_us = now + ttl_us_;
+        } else if (!entry.valid || now >= entry.expire_at_us) {
+            // 后台刷新失败时保留尚未过期的旧地址
+            entry.valid = false;
+            entry.resolved_at_us = now;
+            entry.expire_at_us = now + negative_ttl_us_;
+        }
+    }
+    cv_.notify_all();
+}
+
+void DnsCache::Prefetch(const std::string& host) {
+    std::vector<struct sockaddr_storage> addrs;
+    if (ParseLiteral(host, addrs)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(host);
+        if (it != entries_.end() && (it->second.resolving || (it->second.valid && esp_timer_get_time() < it->second.expire_at_us))) {
+            return;
+        }
+        entries_[host].resolving = true;
+    }
+    StartPrefetch(host);
+}
+
+void DnsCache::StartPrefetch(const std::string& host) {
+    // 调用前已将条目标记为 resolving
+    auto arg = new std::string(host);
+    auto ret = xTaskCreate([](void* arg) {
+        auto host = (std::string*)arg;
+        std::vector<struct sockaddr_storage> addrs;
+        DnsCache::GetInstance().Lookup(*host, addrs);
+        delete host;
+        vTaskDelete(NULL);
+    }, "dns_prefetch", 4096, arg, 2, nullptr);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create prefetch task for %s", host.c_str());
+        delete arg;
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_[host].resolving = false;
+        cv_.notify_all();
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.prefetches++;
+}
+
+void DnsCache::Invalidate(const std::string& host) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(host);
+    if (it == entries_.end() || it->second.resolving) {
+        return;
+    }
+    // 刚解析到的地址连不上多半是对端或网络的问题，重新解析也得到同样的结果
+    if (esp_timer_get_time() - it->second.resolved_at_us < DNS_CACHE_MIN_INVALIDATE_INTERVAL_SECONDS * 1000000LL) {
+        return;
+    }
+    entries_.erase(it);
+}
+
+void DnsCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.resolving) {
+            ++it;
+        } else {
+            it = entries_.erase(it);
+        }
+    }
+}
+
+DnsCacheStats DnsCache::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
@@ -0,0 +1,135 @@
+#include "encrypted_udp.h"
+#include <esp_log.h>
+#include <esp_random.h>
+#include <cstring>
+#include <algorithm>
+
+static const char *TAG = "EncryptedUdp";
+
+EncryptedUdp::EncryptedUdp(Udp* udp, const std::string& key, const std::string& salt, EncryptedUdpRole role) : udp_(udp) {
+    bool client = role == EncryptedUdpRole::Client;
+    send_direction_ = client ? ENCRYPTED_UDP_DIRECTION_UPLINK : ENCRYPTED_UDP_DIRECTION_DOWNLINK;
+    receive_direction_ = client ? ENCRYPTED_UDP_DIRECTION_DOWNLINK : ENCRYPTED_UDP_DIRECTION_UPLINK;
+    mbedtls_aes_init(&send_aes_);
+    mbedtls_aes_init(&receive_aes_);
+    if (key.size() != 16 && key.size() != 24 && key.size() != 32) {
+        ESP_LOGE(TAG, "Invalid key size: %zu", key.size());
+    } else if (mbedtls_aes_setkey_enc(&send_aes_, (const unsigned char*)key.data(), key.size() * 8) == 0
+        && mbedtls_aes_setkey_enc(&receive_aes_, (const unsigned char*)key.data(), key.size() * 8) == 0) {
+        key_valid_ = true;
+    }
+    memset(salt_, 0, sizeof(salt_));
+    memcpy(salt_, salt.data(), std::min(salt.size(), sizeof(salt_)));
+}
+
+EncryptedUdp::~EncryptedUdp() {
+    delete udp_;
+    mbedtls_aes_free(&send_aes_);
+    mbedtls_aes_free(&receive_aes_);
+}
+
+bool EncryptedUdp::Connect(const std::string& host, int port) {
+    if (!key_valid_) {
+        return false;
+    }
+    {
+        // 新连接使用新的随机会话号，序号可以从 0 开始
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        esp_fill_random(&send_session_, sizeof(send_session_));
+        send_sequence_ = 0;
+    }
+    connected_ = udp_->Connect(host, port);
+    return connected_;
+}
+
+void EncryptedUdp::Disconnect() {
+    udp_->Disconnect();
+    connected_ = false;
+}
+
+static void WriteUint32(char* dest, uint32_t value) {
+    dest[0] = value >> 24;
+    dest[1] = value >> 16;
+    dest[2] = value >> 8;
+    dest[3] = value;
+}
+
+void EncryptedUdp::Crypt(mbedtls_aes_context* aes, uint32_t session, uint32_t sequence, uint8_t direction, const char* input, char* output, size_t length) {
+    uint8_t counter[16];
+    uint8_t stream_block[16];
+    size_t offset = 0;
+    memcpy(counter, salt_, ENCRYPTED_UDP_SALT_SIZE);
+    counter[0] ^= session >> 24;
+    counter[1] ^= session >> 16;
+    counter[2] ^= session >> 8;
+    counter[3] ^= session;
+    WriteUint32((char*)counter + 8, sequence);
+    memset(counter + 12, 0, 4);
+    counter[12] = direction;
+    mbedtls_aes_crypt_ctr(aes, length, &offset, counter, stream_block, (const unsigned char*)input, (unsigned char*)output);
+}
+
+int EncryptedUdp::Send(const std::string& data) {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    uint32_t session = send_session_;
+    uint32_t sequence = send_sequence_++;
+    if (send_sequence_ == 0) {
+        // 序号用完，下一个数据报换新的会话号
+        esp_fill_random(&send_session_, sizeof(send_session_));
+    }
+    // 缓冲区只在数据报变大时重新分配，密文直接写入其中
+    send_buffer_.resize(ENCRYPTED_UDP_HEADER_SIZE + data.size());
+    char* header = send_buffer_.data();
+    WriteUint32(header, session);
+    WriteUint32(header + 4, sequence);
+    Crypt(&send_aes_, session, sequence, send_direction_, data.data(), header + ENCRYPTED_UDP_HEADER_SIZE, data.size());
+    int ret = udp_->Send(send_buffer_);
+    return ret > ENCRYPTED_UDP_HEADER_SIZE ? ret - ENCRYPTED_UDP_HEADER_SIZE : ret;
+}
+
+static uint32_t ReadUint32(const char* data) {
+    const uint8_t* p = (const uint8_t*)data;
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+void EncryptedUdp::OnMessage(std::function<void(const std::string& data)> callback) {
+    message_callback_ = callback;
+    udp_->OnMessage([this](const std::string& data) {
+        if (data.size() < ENCRYPTED_UDP_HEADER_SIZE) {
+            decrypt_failures_++;
+            return;
+        }
+        // 解密缓冲区复用，回调期间持有 receive_mutex_
+        std::lock_guard<std::mutex> lock(receive_mutex_);
+        size_t length = data.size() - ENCRYPTED_UDP_HEADER_SIZE;
+        receive_buffer_.resize(length);
+        Crypt(&receive_aes_, ReadUint32(data.data()), ReadUint32(data.data() + 4), receive_direction_,
+            data.data() + ENCRYPTED_UDP_HEADER_SIZE, receive_buffer_.data(), length);
+        if (message_callback_) {
+            message_callback_(receive_buffer_);
+        }
+    });
+}
+
+void EncryptedUdp::OnMessageBuffer(std::function<void(DatagramBuffer buffer)> callback) {
+    buffer_callback_ = callback;
+    udp_->OnMessageBuffer([this](DatagramBuffer buffer) {
+        if (buffer.size() < ENCRYPTED_UDP_HEADER_SIZE) {
+            decrypt_failures_++;
+            return;
+        }
+        // 原地解密后把明文移到缓冲区开头
+        char* data = buffer.data();
+        size_t length = buffer.size() - ENCRYPTED_UDP_HEADER_SIZE;
+        {
+            std::lock_guard<std::mutex> lock(receive_mutex_);
+            Crypt(&receive_aes_, ReadUint32(data), ReadUint32(data + 4), receive_direction_,
+                data + ENCRYPTED_UDP_HEADER_SIZE, data + ENCRYPTED_UDP_HEADER_SIZE, length);
+        }
+        memmove(data, data + ENCRYPTED_UDP_HEADER_SIZE, length);
+        buffer.set_size(length);
+        if (buffer_callback_) {
+            buffer_callback_(std::move(buffer));
+        }
+    });
+}
@@ -0,0 +1,37 @@
+#include "esp_backend.h"
+#include "tls_transport.h"
+#include "esp_http.h"
+#include "esp_mqtt.h"
+#include "esp_udp.h"
+#include "esp_udp_endpoint.h"
+
+#include <esp_netif.h>
+
+bool EspBackend::IsReady() {
+    esp_netif_t* netif = esp_netif_get_default_netif();
+    if (netif == nullptr || !esp_netif_is_netif_up(netif)) {
+        return false;
+    }
+    esp_netif_ip_info_t ip_info;
+    return esp_netif_get_ip_info(netif, &ip_info) == ESP_OK && ip_info.ip.addr != 0;
+}
+
+Transport* EspBackend::CreateTlsTransport() {
+    return new TlsTransport();
+}
+
+Http* EspBackend::CreateHttp() {
+    return new EspHttp();
+}
+
+Mqtt* EspBackend::CreateMqtt() {
+    return new EspMqtt();
+}
+
+Udp* EspBackend::CreateUdp() {
+    return new EspUdp();
+}
+
+UdpEndpoint* EspBackend::CreateUdpEndpoint() {
+    return new EspUdpEndpoint();
+}
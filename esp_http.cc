@@ -2,14 +2,86 @@
 #include <esp_tls.h>
 #include <esp_log.h>
 #include <esp_crt_bundle.h>
+#include <esp_timer.h>
 #include <cstring>
+#include <algorithm>
 
 static const char* TAG = "EspHttp";
 
-EspHttp::EspHttp() : client_(nullptr), status_code_(0) {}
+// 定时器回调只持有实例 id，通过这张表找到仍然存活的实例；
+// esp_timer_stop 不会等待正在执行的回调，析构时先从表中移除，回调持有 timers_mutex 期间实例不会被释放
+static std::mutex timers_mutex;
+static std::map<uint32_t, EspHttp*> timers;
+static uint32_t next_timer_id = 1;
+
+// 回调触发时连接正被使用，稍后再检查
+#define HTTP_IDLE_RETRY_MS 1000
+
+EspHttp::EspHttp() : client_(nullptr), status_code_(0), content_length_(0) {
+    {
+        std::lock_guard<std::mutex> lock(timers_mutex);
+        timer_id_ = next_timer_id++;
+        timers[timer_id_] = this;
+    }
+    esp_timer_create_args_t timer_args = {};
+    timer_args.callback = &EspHttp::OnIdleTimer;
+    timer_args.arg = (void*)(uintptr_t)timer_id_;
+    timer_args.dispatch_method = ESP_TIMER_TASK;
+    timer_args.name = "http_idle";
+    if (esp_timer_create(&timer_args, &idle_timer_) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create idle timer");
+        idle_timer_ = nullptr;
+    }
+}
 
 EspHttp::~EspHttp() {
-    Close();
+    {
+        // 等待正在执行的回调结束，之后的回调找不到这个实例
+        std::lock_guard<std::mutex> lock(timers_mutex);
+        timers.erase(timer_id_);
+    }
+    if (idle_timer_ != nullptr) {
+        esp_timer_stop(idle_timer_);
+        esp_timer_delete(idle_timer_);
+    }
+    ReleaseClient();
+}
+
+void EspHttp::OnIdleTimer(void* arg) {
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    auto it = timers.find((uint32_t)(uintptr_t)arg);
+    if (it == timers.end()) {
+        return;
+    }
+    EspHttp* http = it->second;
+    // 不在 esp_timer 任务中等待网络读写，连接正被使用时稍后重试
+    std::unique_lock<std::mutex> client_lock(http->client_mutex_, std::try_to_lock);
+    if (!client_lock.owns_lock()) {
+        esp_timer_start_once(http->idle_timer_, HTTP_IDLE_RETRY_MS * 1000LL);
+        return;
+    }
+    // 定时器触发前已经开始了新的请求
+    if (!http->idle_) {
+        return;
+    }
+    ESP_LOGI(TAG, "Closing idle connection to %s", http->origin_.c_str());
+    http->idle_ = false;
+    http->ReleaseClient();
+}
+
+void EspHttp::StartIdleTimer() {
+    idle_ = true;
+    if (idle_timer_ != nullptr) {
+        esp_timer_stop(idle_timer_);
+        esp_timer_start_once(idle_timer_, idle_timeout_ms_ * 1000LL);
+    }
+}
+
+void EspHttp::StopIdleTimer() {
+    idle_ = false;
+    if (idle_timer_ != nullptr) {
+        esp_timer_stop(idle_timer_);
+    }
 }
 
 void EspHttp::SetHeader(const std::string& key, const std::string& value) {
@@ -17,55 +89,183 @@ void EspHttp::SetHeader(const std::string& key, const std::string& value) {
 }
 
 bool EspHttp::Open(const std::string& method, const std::string& url, const std::string& content) {
-    esp_http_client_config_t config = {};
-    config.url = url.c_str();
-    config.crt_bundle_attach = esp_crt_bundle_attach;
+    std::lock_guard<std::mutex> lock(client_mutex_);
+    if (!OpenRequest(method, url, content.length())) {
+        return false;
+    }
 
-    ESP_LOGI(TAG, "Opening HTTP connection to %s", url.c_str());
+    auto written = esp_http_client_write(client_, content.data(), content.length());
+    if (written < 0) {
+        ESP_LOGE(TAG, "Failed to write request body");
+        ReleaseClient();
+        return false;
+    }
+    return FetchResponse();
+}
 
-    client_ = esp_http_client_init(&config);
-    if (!client_) {
-        ESP_LOGE(TAG, "Failed to initialize HTTP client");
+bool EspHttp::OpenStream(const std::string& method, const std::string& url) {
+    std::lock_guard<std::mutex> lock(client_mutex_);
+    // 长度为 -1 时 esp_http_client 使用 Transfer-Encoding: chunked
+    return OpenRequest(method, url, -1);
+}
+
+int EspHttp::Write(const char* data, size_t length) {
+    std::lock_guard<std::mutex> lock(client_mutex_);
+    if (!client_) return -1;
+    if (length == 0) {
+        // 空块是结束标记，由 FinishStream 发送
+        return 0;
+    }
+    char header[16];
+    int header_length = snprintf(header, sizeof(header), "%x\r\n", (unsigned)length);
+    if (esp_http_client_write(client_, header, header_length) != header_length
+        || esp_http_client_write(client_, data, length) != (int)length
+        || esp_http_client_write(client_, "\r\n", 2) != 2) {
+        ESP_LOGE(TAG, "Failed to write request chunk");
+        ReleaseClient();
+        return -1;
+    }
+    return length;
+}
+
+bool EspHttp::FinishStream() {
+    std::lock_guard<std::mutex> lock(client_mutex_);
+    if (!client_) return false;
+    if (esp_http_client_write(client_, "0\r\n\r\n", 5) != 5) {
+        ESP_LOGE(TAG, "Failed to finish chunked request");
+        ReleaseClient();
         return false;
     }
+    return FetchResponse();
+}
 
-    esp_http_client_set_method(client_, 
-        method == "GET" ? HTTP_METHOD_GET : 
-        method == "POST" ? HTTP_METHOD_POST : 
-        method == "PUT" ? HTTP_METHOD_PUT : 
-        method == "DELETE" ? HTTP_METHOD_DELETE : HTTP_METHOD_GET);
+bool EspHttp::OpenRequest(const std::string& method, const std::string& url, int write_length) {
+    response_body_.clear();
+    status_code_ = 0;
+    content_length_ = 0;
 
-    for (const auto& header : headers_) {
-        esp_http_client_set_header(client_, header.first.c_str(), header.second.c_str());
+    // 连接空闲太久或目标不同则重新建立；定时器没能创建时在这里检查空闲时间
+    StopIdleTimer();
+    bool reused = false;
+    if (client_) {
+        bool expired = esp_timer_get_time() - last_used_us_ > idle_timeout_ms_ * 1000LL;
+        if (keep_alive_ && !expired && GetOrigin(url) == origin_ && esp_http_client_set_url(client_, url.c_str()) == ESP_OK) {
+            reused = true;
+        } else {
+            ReleaseClient();
+        }
     }
 
-    esp_err_t err = esp_http_client_open(client_, content.length());
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to perform HTTP request: %s", esp_err_to_name(err));
-        Close();
+    ESP_LOGI(TAG, "Opening HTTP connection to %s%s", url.c_str(), reused ? " (reused)" : "");
+
+    if (!client_ && !InitClient(url)) {
         return false;
     }
 
-    auto written = esp_http_client_write(client_, content.data(), content.length());
-    if (written < 0) {
-        ESP_LOGE(TAG, "Failed to write request body: %s", esp_err_to_name(err));
-        Close();
+    SetupRequest(method);
+    esp_err_t err = esp_http_client_open(client_, write_length);
+    if (err != ESP_OK && reused) {
+        // 服务器可能已关闭空闲连接，重新建立一次
+        ESP_LOGW(TAG, "Reused connection failed, reconnecting");
+        ReleaseClient();
+        if (!InitClient(url)) {
+            return false;
+        }
+        SetupRequest(method);
+        err = esp_http_client_open(client_, write_length);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to perform HTTP request: %s", esp_err_to_name(err));
+        ReleaseClient();
         return false;
     }
+    return true;
+}
+
+bool EspHttp::FetchResponse() {
+    // 分块响应没有 Content-Length，返回 0
     content_length_ = esp_http_client_fetch_headers(client_);
-    if (content_length_ <= 0) {
+    if (content_length_ < 0) {
         ESP_LOGE(TAG, "Failed to fetch headers");
-        Close();
+        ReleaseClient();
         return false;
     }
+    if (esp_http_client_is_chunked_response(client_)) {
+        content_length_ = -1;
+    }
+    status_code_ = esp_http_client_get_status_code(client_);
     return true;
 }
 
 void EspHttp::Close() {
+    std::lock_guard<std::mutex> lock(client_mutex_);
+    if (!client_) {
+        return;
+    }
+    if (!keep_alive_) {
+        ReleaseClient();
+        return;
+    }
+    // 读掉未读完的响应体，连接才能用于下一个请求
+    if (esp_http_client_flush_response(client_, nullptr) != ESP_OK) {
+        ReleaseClient();
+        return;
+    }
+    last_used_us_ = esp_timer_get_time();
+    // 空闲超时后由定时器关闭连接，避免套接字一直占用
+    StartIdleTimer();
+}
+
+void EspHttp::SetKeepAlive(bool enable, int idle_timeout_ms) {
+    std::lock_guard<std::mutex> lock(client_mutex_);
+    keep_alive_ = enable;
+    idle_timeout_ms_ = idle_timeout_ms;
+    if (!keep_alive_) {
+        StopIdleTimer();
+        ReleaseClient();
+    }
+}
+
+std::string EspHttp::GetOrigin(const std::string& url) {
+    // scheme://host[:port]，不含路径和查询参数
+    size_t start = url.find("://");
+    start = start == std::string::npos ? 0 : start + 3;
+    size_t end = url.find_first_of("/?#", start);
+    return url.substr(0, end);
+}
+
+bool EspHttp::InitClient(const std::string& url) {
+    esp_http_client_config_t config = {};
+    config.url = url.c_str();
+    config.crt_bundle_attach = esp_crt_bundle_attach;
+    config.keep_alive_enable = keep_alive_;
+
+    client_ = esp_http_client_init(&config);
+    if (!client_) {
+        ESP_LOGE(TAG, "Failed to initialize HTTP client");
+        return false;
+    }
+    origin_ = GetOrigin(url);
+    return true;
+}
+
+void EspHttp::SetupRequest(const std::string& method) {
+    esp_http_client_set_method(client_, 
+        method == "GET" ? HTTP_METHOD_GET : 
+        method == "POST" ? HTTP_METHOD_POST : 
+        method == "PUT" ? HTTP_METHOD_PUT : 
+        method == "DELETE" ? HTTP_METHOD_DELETE : HTTP_METHOD_GET);
+    for (const auto& header : headers_) {
+        esp_http_client_set_header(client_, header.first.c_str(), header.second.c_str());
+    }
+}
+
+void EspHttp::ReleaseClient() {
     if (client_) {
         esp_http_client_cleanup(client_);
         client_ = nullptr;
     }
+    origin_.clear();
 }
 
 int EspHttp::GetStatusCode() const {
@@ -73,6 +273,7 @@ int EspHttp::GetStatusCode() const {
 }
 
 std::string EspHttp::GetResponseHeader(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(client_mutex_);
     if (!client_) return "";
     char* value = nullptr;
     esp_http_client_get_header(client_, key.c_str(), &value);
@@ -83,16 +284,48 @@ std::string EspHttp::GetResponseHeader(const std::string& key) const {
 }
 
 size_t EspHttp::GetBodyLength() const {
-    return content_length_;
+    // 分块响应在读完之前长度未知
+    return content_length_ >= 0 ? content_length_ : response_body_.size();
+}
+
+void EspHttp::SetMaxBodySize(size_t max_body_size) {
+    max_body_size_ = max_body_size;
 }
 
 const std::string& EspHttp::GetBody() {
-    response_body_.resize(content_length_);
-    assert(Read(const_cast<char*>(response_body_.data()), content_length_) == content_length_);
+    std::lock_guard<std::mutex> lock(client_mutex_);
+    if (!client_) return response_body_;
+    if (content_length_ > 0) {
+        response_body_.reserve(std::min((size_t)content_length_, max_body_size_));
+    }
+
+    // 一直读到连接上没有更多数据，兼容分块响应
+    char buffer[512];
+    while (true) {
+        int ret = ReadLocked(buffer, sizeof(buffer));
+        if (ret < 0) {
+            ESP_LOGE(TAG, "Failed to read response body");
+            break;
+        }
+        if (ret == 0) {
+            break;
+        }
+        if (response_body_.size() + ret > max_body_size_) {
+            ESP_LOGE(TAG, "Response body exceeds %zu bytes, truncated", max_body_size_);
+            response_body_.append(buffer, max_body_size_ - response_body_.size());
+            break;
+        }
+        response_body_.append(buffer, ret);
+    }
     return response_body_;
 }
 
 int EspHttp::Read(char* buffer, size_t buffer_size) {
+    std::lock_guard<std::mutex> lock(client_mutex_);
+    return ReadLocked(buffer, buffer_size);
+}
+
+int EspHttp::ReadLocked(char* buffer, size_t buffer_size) {
     if (!client_) return -1;
     return esp_http_client_read(client_, buffer, buffer_size);
 }
@@ -16,7 +16,7 @@ EspMqtt::~EspMqtt() {
     vEventGroupDelete(event_group_handle_);
 }
 
-bool EspMqtt::Connect(const std::string broker_address, int broker_port, const std::string client_id, const std::string username, const std::string password) {
+bool EspMqtt::Connect(const std::string& broker_address, int broker_port, const std::string& client_id, const std::string& username, const std::string& password) {
     if (mqtt_client_handle_ != nullptr) {
         Disconnect();
     }
@@ -24,17 +24,45 @@ bool EspMqtt::Connect(const std::string broker_address, int broker_port, const s
     esp_mqtt_client_config_t mqtt_config = {};
     mqtt_config.broker.address.hostname = broker_address.c_str();
     mqtt_config.broker.address.port = broker_port;
-    mqtt_config.broker.address.path = "/mqtt";
-    if (broker_port == 8883) {
+    auto transport = config_.transport;
+    if (transport == MqttTransport::Auto) {
+        transport = broker_port == 8883 ? MqttTransport::Ssl : MqttTransport::Ws;
+    }
+    switch (transport) {
+    case MqttTransport::Tcp:
+        mqtt_config.broker.address.transport = MQTT_TRANSPORT_OVER_TCP;
+        break;
+    case MqttTransport::Ssl:
         mqtt_config.broker.address.transport = MQTT_TRANSPORT_OVER_SSL;
-        mqtt_config.broker.verification.crt_bundle_attach = esp_crt_bundle_attach;
-    } else {
+        break;
+    case MqttTransport::Wss:
+        mqtt_config.broker.address.transport = MQTT_TRANSPORT_OVER_WSS;
+        break;
+    default:
         mqtt_config.broker.address.transport = MQTT_TRANSPORT_OVER_WS;
+        break;
+    }
+    if (transport == MqttTransport::Ws || transport == MqttTransport::Wss) {
+        mqtt_config.broker.address.path = config_.path.c_str();
     }
+    if (transport == MqttTransport::Ssl || transport == MqttTransport::Wss) {
+        mqtt_config.broker.verification.crt_bundle_attach = esp_crt_bundle_attach;
+    }
+    mqtt_config.buffer.size = config_.buffer_size;
+    mqtt_config.buffer.out_size = config_.out_buffer_size;
+    mqtt_config.outbox.limit = config_.outbox_limit;
+    mqtt_config.task.priority = config_.task_priority;
+    mqtt_config.task.stack_size = config_.task_stack_size;
     mqtt_config.credentials.client_id = client_id.c_str();
     mqtt_config.credentials.username = username.c_str();
     mqtt_config.credentials.authentication.password = password.c_str();
     mqtt_config.session.keepalive = keep_alive_seconds_;
+    mqtt_config.session.disable_clean_session = !clean_session_;
+    // esp-mqtt 自带重连，间隔固定为 reconnect_timeout_ms；未显式设置时沿用 esp-mqtt 的默认值
+    if (auto_reconnect_configured_) {
+        mqtt_config.network.disable_auto_reconnect = !auto_reconnect_;
+        mqtt_config.network.reconnect_timeout_ms = reconnect_min_backoff_ms_;
+    }
     mqtt_client_handle_ = esp_mqtt_client_init(&mqtt_config);
     esp_mqtt_client_register_event(mqtt_client_handle_, MQTT_EVENT_ANY, [](void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data) {
         ((EspMqtt*)handler_args)->MqttEventCallback(base, event_id, event_data);
@@ -51,32 +79,71 @@ void EspMqtt::MqttEventCallback(esp_event_base_t base, int32_t event_id, void *e
     auto event = (esp_mqtt_event_t*)event_data;
     switch (event_id) {
     case MQTT_EVENT_CONNECTED:
+        connected_ = true;
+        // 服务器没有保留会话时重新订阅（首次连接时集合为空）
+        if (!event->session_present) {
+            // 事件回调运行在 esp-mqtt 任务中，这里只提交订阅，不等待 SUBACK
+            auto subscriptions = GetSubscribedTopics();
+            std::vector<esp_mqtt_topic_t> topics;
+            topics.reserve(subscriptions.size());
+            for (auto& subscription : subscriptions) {
+                topics.push_back({subscription.filter.c_str(), subscription.qos});
+            }
+            if (!topics.empty()) {
+                esp_mqtt_client_subscribe_multiple(mqtt_client_handle_, topics.data(), topics.size());
+            }
+        }
         xEventGroupSetBits(event_group_handle_, MQTT_CONNECTED_EVENT);
+        if (on_connected_callback_) {
+            on_connected_callback_();
+        }
         break;
     case MQTT_EVENT_DISCONNECTED:
-        connected_ = false;
+        if (connected_) {
+            connected_ = false;
+            if (on_disconnected_callback_) {
+                on_disconnected_callback_();
+            }
+        }
         xEventGroupSetBits(event_group_handle_, MQTT_DISCONNECTED_EVENT);
         break;
     case MQTT_EVENT_DATA: {
-        auto topic = std::string(event->topic, event->topic_len);
-        auto payload = std::string(event->data, event->data_len);
         if (event->data_len == event->total_data_len) {
-            if (on_message_callback_) {
-                on_message_callback_(topic, payload);
-            }
-        } else {
-            message_payload_.append(payload);
-            if (message_payload_.size() >= event->total_data_len && on_message_callback_) {
-                on_message_callback_(topic, message_payload_);
-                message_payload_.clear();
-            }
+            DispatchMessage(std::string_view(event->topic, event->topic_len), std::string_view(event->data, event->data_len));
+            break;
+        }
+        // 只有第一段带主题，后续分段按报文 ID 关联
+        auto key = std::to_string(event->msg_id);
+        if (event->current_data_offset == 0) {
+            assembler_.Remove(key);
+        }
+        auto message = assembler_.Get(key, std::string(event->topic, event->topic_len), event->total_data_len);
+        if (message == nullptr || message->payload.size() != (size_t)event->current_data_offset) {
+            assembler_.Remove(key);
+            break;
+        }
+        message->payload.append(event->data, event->data_len);
+        if (message->payload.size() >= message->total_length) {
+            DispatchMessage(message->topic, message->payload);
+            assembler_.Remove(key);
         }
         break;
     }
     case MQTT_EVENT_BEFORE_CONNECT:
         break;
-    case MQTT_EVENT_SUBSCRIBED:
+    case MQTT_EVENT_SUBSCRIBED: {
+        // data 中依次是每个过滤器的 SUBACK 返回码
+        std::lock_guard<std::mutex> lock(suback_mutex_);
+        if (subscribing_) {
+            auto& codes = suback_results_[event->msg_id];
+            codes.clear();
+            for (int i = 0; i < event->data_len; i++) {
+                codes.push_back((uint8_t)event->data[i]);
+            }
+            xEventGroupSetBits(event_group_handle_, MQTT_SUBSCRIBED_EVENT);
+        }
         break;
+    }
     case MQTT_EVENT_ERROR:
         xEventGroupSetBits(event_group_handle_, MQTT_ERROR_EVENT);
         ESP_LOGI(TAG, "MQTT error occurred: %s", esp_err_to_name(event->error_handle->esp_tls_last_esp_err));
@@ -95,25 +162,93 @@ void EspMqtt::Disconnect() {
     xEventGroupClearBits(event_group_handle_, MQTT_CONNECTED_EVENT | MQTT_DISCONNECTED_EVENT | MQTT_ERROR_EVENT);
 }
 
-bool EspMqtt::Publish(const std::string topic, const std::string payload, int qos) {
+bool EspMqtt::Publish(std::string_view topic, std::string_view payload, int qos) {
     if (!connected_) {
         return false;
     }
-    return esp_mqtt_client_publish(mqtt_client_handle_, topic.c_str(), payload.data(), payload.size(), qos, 0) == 0;
+    // esp-mqtt 需要以 '\0' 结尾的主题，负载直接传指针
+    std::string topic_string(topic);
+    return esp_mqtt_client_publish(mqtt_client_handle_, topic_string.c_str(), payload.data(), payload.size(), qos, 0) >= 0;
 }
 
-bool EspMqtt::Subscribe(const std::string topic, int qos) {
+bool EspMqtt::Subscribe(const std::string& topic, int qos) {
     if (!connected_) {
         return false;
     }
-    return esp_mqtt_client_subscribe_single(mqtt_client_handle_, topic.c_str(), qos) == 0;
+    if (esp_mqtt_client_subscribe_single(mqtt_client_handle_, topic.c_str(), qos) < 0) {
+        return false;
+    }
+    RememberSubscription(topic, qos);
+    return true;
+}
+
+bool EspMqtt::SubscribeMultiple(std::vector<MqttSubscription>& subscriptions) {
+    if (!connected_ || subscriptions.empty()) {
+        return false;
+    }
+
+    std::vector<esp_mqtt_topic_t> topics;
+    topics.reserve(subscriptions.size());
+    for (auto& subscription : subscriptions) {
+        subscription.granted_qos = MQTT_SUBACK_FAILURE;
+        topics.push_back({subscription.filter.c_str(), subscription.qos});
+    }
+
+    std::lock_guard<std::mutex> lock(subscribe_mutex_);
+    {
+        std::lock_guard<std::mutex> suback_lock(suback_mutex_);
+        suback_results_.clear();
+        subscribing_ = true;
+    }
+    xEventGroupClearBits(event_group_handle_, MQTT_SUBSCRIBED_EVENT);
+    int msg_id = esp_mqtt_client_subscribe_multiple(mqtt_client_handle_, topics.data(), topics.size());
+
+    // 等待与本次 msg_id 对应的 SUBACK，其它订阅的 SUBACK 不会被算到这一批
+    bool success = false;
+    auto deadline = xTaskGetTickCount() + pdMS_TO_TICKS(MQTT_SUBSCRIBE_TIMEOUT_MS);
+    while (msg_id >= 0) {
+        {
+            std::lock_guard<std::mutex> suback_lock(suback_mutex_);
+            auto it = suback_results_.find(msg_id);
+            if (it != suback_results_.end()) {
+                auto& codes = it->second;
+                if (codes.size() != subscriptions.size()) {
+                    // 结果数量和过滤器数量不一致时无法判断哪个主题成功，全部视为失败
+                    ESP_LOGW(TAG, "SUBACK has %u codes for %u topics", (unsigned)codes.size(), (unsigned)subscriptions.size());
+                    break;
+                }
+                success = true;
+                for (size_t i = 0; i < subscriptions.size(); i++) {
+                    subscriptions[i].granted_qos = codes[i];
+                    if (codes[i] == MQTT_SUBACK_FAILURE) {
+                        success = false;
+                    } else {
+                        RememberSubscription(subscriptions[i].filter, subscriptions[i].qos);
+                    }
+                }
+                break;
+            }
+        }
+        auto now = xTaskGetTickCount();
+        if ((int32_t)(deadline - now) <= 0) {
+            ESP_LOGW(TAG, "No SUBACK for message %d", msg_id);
+            break;
+        }
+        xEventGroupWaitBits(event_group_handle_, MQTT_SUBSCRIBED_EVENT, pdTRUE, pdFALSE, deadline - now);
+    }
+
+    std::lock_guard<std::mutex> suback_lock(suback_mutex_);
+    subscribing_ = false;
+    suback_results_.clear();
+    return success;
 }
 
-bool EspMqtt::Unsubscribe(const std::string topic) {
+bool EspMqtt::Unsubscribe(const std::string& topic) {
     if (!connected_) {
         return false;
     }
-    return esp_mqtt_client_unsubscribe(mqtt_client_handle_, topic.c_str()) == 0;
+    ForgetSubscription(topic);
+    return esp_mqtt_client_unsubscribe(mqtt_client_handle_, topic.c_str()) >= 0;
 }
 
 bool EspMqtt::IsConnected() {
@@ -1,19 +1,32 @@
 #include "esp_udp.h"
+#include "dns_cache.h"
 
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <unistd.h>
 #include <cstring>
+#include <algorithm>
+#include <cerrno>
 #include <arpa/inet.h>
 #include <sys/socket.h>
+#include <sys/select.h>
 #include <netdb.h>
 
 static const char *TAG = "EspUdp";
 
 EspUdp::EspUdp() : udp_fd_(-1) {
+    event_group_handle_ = xEventGroupCreate();
 }
 
 EspUdp::~EspUdp() {
     Disconnect();
+    vEventGroupDelete(event_group_handle_);
+}
+
+void EspUdp::SetReceiveTask(int priority, int core, int stack_size) {
+    task_priority_ = priority;
+    task_core_ = core;
+    task_stack_size_ = stack_size;
 }
 
 bool EspUdp::Connect(const std::string& host, int port) {
@@ -21,13 +34,10 @@ bool EspUdp::Connect(const std::string& host, int port) {
     bzero(&server_addr, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
     server_addr.sin_port = htons(port);
-    // host is domain
-    struct hostent *server = gethostbyname(host.c_str());
-    if (server == NULL) {
-        ESP_LOGE(TAG, "Failed to get host by name");
+    if (!DnsCache::GetInstance().Resolve(host, server_addr.sin_addr)) {
+        ESP_LOGE(TAG, "Failed to resolve %s", host.c_str());
         return false;
     }
-    memcpy(&server_addr.sin_addr, server->h_addr, server->h_length);
 
     udp_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
     if (udp_fd_ < 0) {
@@ -44,19 +54,37 @@ bool EspUdp::Connect(const std::string& host, int port) {
     }
 
     connected_ = true;
-    receive_thread_ = std::thread(&EspUdp::ReceiveTask, this);
+    stopping_ = false;
+    xEventGroupClearBits(event_group_handle_, ESP_UDP_RECEIVE_TASK_EXIT);
+    ret = xTaskCreatePinnedToCore([](void* arg) {
+        auto udp = (EspUdp*)arg;
+        udp->ReceiveTask();
+        xEventGroupSetBits(udp->event_group_handle_, ESP_UDP_RECEIVE_TASK_EXIT);
+        vTaskDelete(NULL);
+    }, "udp_receive", task_stack_size_, this, task_priority_, &receive_task_handle_, task_core_);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create receive task");
+        receive_task_handle_ = nullptr;
+        close(udp_fd_);
+        udp_fd_ = -1;
+        connected_ = false;
+        return false;
+    }
     return true;
 }
 
 void EspUdp::Disconnect() {
+    // 先让接收任务退出再关闭套接字，避免任务读到已被复用的描述符
+    if (receive_task_handle_ != nullptr) {
+        stopping_ = true;
+        xEventGroupWaitBits(event_group_handle_, ESP_UDP_RECEIVE_TASK_EXIT, pdTRUE, pdFALSE, portMAX_DELAY);
+        receive_task_handle_ = nullptr;
+    }
     if (udp_fd_ != -1) {
         close(udp_fd_);
         udp_fd_ = -1;
     }
     connected_ = false;
-    if (receive_thread_.joinable()) {
-        receive_thread_.join();
-    }
 }
 
 int EspUdp::Send(const std::string& data) {
@@ -68,17 +96,105 @@ int EspUdp::Send(const std::string& data) {
     return ret;
 }
 
+UdpReceiveStats EspUdp::GetReceiveStats() {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    UdpReceiveStats stats = receive_stats_;
+    stats.dropped = dropped_count_;
+    stats.average_latency_us = stats.datagrams > 0 ? total_latency_us_ / stats.datagrams : 0;
+    return stats;
+}
+
 void EspUdp::ReceiveTask() {
-    while (true) {
-        std::string data;
-        data.resize(1500);
-        int ret = recv(udp_fd_, data.data(), data.size(), 0);
-        if (ret <= 0) {
+    while (!stopping_) {
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(udp_fd_, &read_fds);
+        struct timeval timeout = {
+            .tv_sec = 0,
+            .tv_usec = ESP_UDP_SELECT_TIMEOUT_MS * 1000,
+        };
+        int ret = select(udp_fd_ + 1, &read_fds, NULL, NULL, &timeout);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ESP_LOGE(TAG, "Select failed: errno=%d", errno);
+            break;
+        }
+        if (ret == 0) {
+            continue;
+        }
+        if (!DrainSocket(esp_timer_get_time())) {
             break;
         }
-        data.resize(ret);
-        if (message_callback_) {
-            message_callback_(data);
+    }
+    connected_ = false;
+}
+
+bool EspUdp::DrainSocket(int64_t ready_time) {
+    uint32_t batch = 0;
+    uint64_t total_latency = 0;
+    uint32_t max_latency = 0;
+    bool ok = true;
+
+    for (int i = 0; i < ESP_UDP_MAX_BATCH; i++) {
+        int ret;
+        DatagramBuffer buffer;
+        if (buffer_callback_) {
+            buffer = buffer_pool_->Acquire();
+        }
+        if (buffer) {
+            // 直接接收到池化缓冲区
+            ret = recv(udp_fd_, buffer.data(), buffer.capacity(), MSG_DONTWAIT);
+            if (ret > 0) {
+                buffer.set_size(ret);
+                uint32_t latency = esp_timer_get_time() - ready_time;
+                buffer_callback_(std::move(buffer));
+                total_latency += latency;
+                max_latency = std::max(max_latency, latency);
+                batch++;
+                continue;
+            }
+        } else if (message_callback_ || !buffer_callback_) {
+            // 未使用缓冲池，或缓冲池耗尽时退回 OnMessage
+            // 复用接收缓冲区，容量不变时不会重新分配
+            receive_buffer_.resize(1500);
+            ret = recv(udp_fd_, receive_buffer_.data(), receive_buffer_.size(), MSG_DONTWAIT);
+            if (ret > 0) {
+                receive_buffer_.resize(ret);
+                uint32_t latency = esp_timer_get_time() - ready_time;
+                if (message_callback_) {
+                    message_callback_(receive_buffer_);
+                }
+                total_latency += latency;
+                max_latency = std::max(max_latency, latency);
+                batch++;
+                continue;
+            }
+        } else {
+            // 缓冲池耗尽且没有 OnMessage，读出并丢弃，否则 select 会一直返回可读
+            char discard[1];
+            ret = recv(udp_fd_, discard, sizeof(discard), MSG_DONTWAIT);
+            if (ret >= 0) {
+                dropped_count_++;
+                continue;
+            }
+        }
+        if (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            ESP_LOGE(TAG, "Receive failed: errno=%d", errno);
+            ok = false;
+        }
+        // 没有更多数据，或者收到空数据报
+        if (ret != 0) {
+            break;
         }
     }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    receive_stats_.wakeups++;
+    receive_stats_.datagrams += batch;
+    receive_stats_.max_batch = std::max(receive_stats_.max_batch, batch);
+    receive_stats_.max_latency_us = std::max(receive_stats_.max_latency_us, max_latency);
+    total_latency_us_ += total_latency;
+    return ok;
 }
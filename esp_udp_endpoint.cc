@@ -0,0 +1,141 @@
+#include "esp_udp_endpoint.h"
+#include "dns_cache.h"
+
+#include <esp_log.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netdb.h>
+
+static const char *TAG = "EspUdpEndpoint";
+
+EspUdpEndpoint::EspUdpEndpoint() {
+    event_group_handle_ = xEventGroupCreate();
+}
+
+EspUdpEndpoint::~EspUdpEndpoint() {
+    Close();
+    vEventGroupDelete(event_group_handle_);
+}
+
+bool EspUdpEndpoint::Bind(int local_port) {
+    Close();
+
+    udp_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (udp_fd_ < 0) {
+        ESP_LOGE(TAG, "Failed to create socket");
+        return false;
+    }
+
+    struct sockaddr_in local_addr;
+    bzero(&local_addr, sizeof(local_addr));
+    local_addr.sin_family = AF_INET;
+    local_addr.sin_port = htons(local_port);
+    local_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(udp_fd_, (struct sockaddr*)&local_addr, sizeof(local_addr)) < 0) {
+        ESP_LOGE(TAG, "Failed to bind port %d", local_port);
+        close(udp_fd_);
+        udp_fd_ = -1;
+        return false;
+    }
+
+    bound_ = true;
+    stopping_ = false;
+    xEventGroupClearBits(event_group_handle_, ESP_UDP_ENDPOINT_RECEIVE_TASK_EXIT);
+    auto ret = xTaskCreate([](void* arg) {
+        auto endpoint = (EspUdpEndpoint*)arg;
+        endpoint->ReceiveTask();
+        xEventGroupSetBits(endpoint->event_group_handle_, ESP_UDP_ENDPOINT_RECEIVE_TASK_EXIT);
+        vTaskDelete(NULL);
+    }, "udp_endpoint", 4096, this, 5, &receive_task_handle_);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create receive task");
+        receive_task_handle_ = nullptr;
+        close(udp_fd_);
+        udp_fd_ = -1;
+        bound_ = false;
+        return false;
+    }
+    return true;
+}
+
+void EspUdpEndpoint::Close() {
+    if (receive_task_handle_ != nullptr) {
+        stopping_ = true;
+        xEventGroupWaitBits(event_group_handle_, ESP_UDP_ENDPOINT_RECEIVE_TASK_EXIT, pdTRUE, pdFALSE, portMAX_DELAY);
+        receive_task_handle_ = nullptr;
+    }
+    if (udp_fd_ != -1) {
+        close(udp_fd_);
+        udp_fd_ = -1;
+    }
+    bound_ = false;
+}
+
+int EspUdpEndpoint::SendTo(const std::string& host, int port, const std::string& data) {
+    if (udp_fd_ == -1) {
+        ESP_LOGE(TAG, "Not bound");
+        return -1;
+    }
+
+    struct sockaddr_in remote_addr;
+    bzero(&remote_addr, sizeof(remote_addr));
+    remote_addr.sin_family = AF_INET;
+    remote_addr.sin_port = htons(port);
+    if (!DnsCache::GetInstance().Resolve(host, remote_addr.sin_addr)) {
+        ESP_LOGE(TAG, "Failed to resolve %s", host.c_str());
+        return -1;
+    }
+
+    int ret = sendto(udp_fd_, data.data(), data.size(), 0, (struct sockaddr*)&remote_addr, sizeof(remote_addr));
+    if (ret < 0) {
+        ESP_LOGE(TAG, "Send to %s:%d failed: errno=%d", host.c_str(), port, errno);
+    }
+    return ret;
+}
+
+void EspUdpEndpoint::ReceiveTask() {
+    std::string data;
+    char host[INET_ADDRSTRLEN];
+    while (!stopping_) {
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(udp_fd_, &read_fds);
+        struct timeval timeout = {
+            .tv_sec = 0,
+            .tv_usec = ESP_UDP_ENDPOINT_SELECT_TIMEOUT_MS * 1000,
+        };
+        int ret = select(udp_fd_ + 1, &read_fds, NULL, NULL, &timeout);
+        if (ret < 0 && errno != EINTR) {
+            ESP_LOGE(TAG, "Select failed: errno=%d", errno);
+            break;
+        }
+        if (ret <= 0) {
+            continue;
+        }
+
+        // 读完当前所有待收的数据报
+        while (true) {
+            struct sockaddr_in source_addr;
+            socklen_t addr_len = sizeof(source_addr);
+            data.resize(1500);
+            ret = recvfrom(udp_fd_, data.data(), data.size(), MSG_DONTWAIT, (struct sockaddr*)&source_addr, &addr_len);
+            if (ret < 0) {
+                break;
+            }
+            data.resize(ret);
+            inet_ntop(AF_INET, &source_addr.sin_addr, host, sizeof(host));
+            if (message_callback_) {
+                message_callback_(host, ntohs(source_addr.sin_port), data);
+            }
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            ESP_LOGE(TAG, "Receive failed: errno=%d", errno);
+            break;
+        }
+    }
+    bound_ = false;
+}
@@ -0,0 +1,14 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "ml307_at_modem.h"
+
+void RunMqttThroughputBenchmark(Ml307AtModem& modem);
+// 不需要网络
+void RunEncryptedUdpBenchmark();
+// 以下通过 Wi-Fi 连接测试服务器
+void RunTcpLatencyBenchmark();
+void RunTlsHandshakeBenchmark();
+void RunTlsCpuBenchmark();
+
+#endif // BENCHMARK_H
@@ -0,0 +1,54 @@
+#include "cpu_meter.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <cstring>
+#include <vector>
+
+static const char *TAG = "CpuMeter";
+
+bool CpuMeter::Sample(uint64_t& idle, uint64_t& total) {
+    // 预留余量，采样期间可能有新任务创建
+    std::vector<TaskStatus_t> tasks(uxTaskGetNumberOfTasks() + 4);
+    configRUN_TIME_COUNTER_TYPE total_run_time = 0;
+    UBaseType_t count = uxTaskGetSystemState(tasks.data(), tasks.size(), &total_run_time);
+    if (count == 0) {
+        ESP_LOGE(TAG, "Failed to get task states");
+        return false;
+    }
+    idle = 0;
+    for (UBaseType_t i = 0; i < count; i++) {
+        // 每个核心一个空闲任务：IDLE0、IDLE1
+        if (strncmp(tasks[i].pcTaskName, "IDLE", 4) == 0) {
+            idle += tasks[i].ulRunTimeCounter;
+        }
+    }
+    total = total_run_time;
+    return true;
+}
+
+void CpuMeter::Start() {
+    busy_us_ = 0;
+    elapsed_us_ = 0;
+    Sample(start_idle_, start_total_);
+}
+
+void CpuMeter::Stop() {
+    uint64_t idle, total;
+    if (!Sample(idle, total)) {
+        return;
+    }
+    // 计数器为 32 位，按计数器宽度取差值，采样间隔不超过一次回绕时结果正确
+    elapsed_us_ = (configRUN_TIME_COUNTER_TYPE)(total - start_total_);
+    int64_t idle_us = (configRUN_TIME_COUNTER_TYPE)(idle - start_idle_);
+    // 总运行时间是墙上时间，每个核心各有这么多
+    busy_us_ = elapsed_us_ * portNUM_PROCESSORS - idle_us;
+}
+
+float CpuMeter::usage_percent() const {
+    if (elapsed_us_ <= 0) {
+        return 0;
+    }
+    return busy_us_ * 100.0f / (elapsed_us_ * portNUM_PROCESSORS);
+}
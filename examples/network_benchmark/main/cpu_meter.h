@@ -0,0 +1,29 @@
+#ifndef CPU_METER_H
+#define CPU_METER_H
+
+#include <cstdint>
+
+// 根据 FreeRTOS 运行时间统计计算一段时间内的 CPU 占用，需开启
+// CONFIG_FREERTOS_USE_TRACE_FACILITY 和 CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+class CpuMeter {
+public:
+    void Start();
+    void Stop();
+
+    // 所有核心的平均占用率，0-100
+    float usage_percent() const;
+    // 所有核心上非空闲任务的运行时间之和
+    int64_t busy_us() const { return busy_us_; }
+    int64_t elapsed_us() const { return elapsed_us_; }
+
+private:
+    uint64_t start_idle_ = 0;
+    uint64_t start_total_ = 0;
+    int64_t busy_us_ = 0;
+    int64_t elapsed_us_ = 0;
+
+    // 返回空闲任务的运行时间之和与总运行时间，单位为运行时间计数器的周期（esp_timer 微秒）
+    static bool Sample(uint64_t& idle, uint64_t& total);
+};
+
+#endif // CPU_METER_H
@@ -0,0 +1,62 @@
+#include "benchmark.h"
+#include "cpu_meter.h"
+#include "encrypted_udp.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <sdkconfig.h>
+#include <string>
+
+static const char *TAG = "EncryptedUdpBenchmark";
+
+// 丢弃所有数据报，只测量 EncryptedUdp 自身的加密和拷贝开销
+class NullUdp : public Udp {
+public:
+    bool Connect(const std::string& host, int port) override {
+        connected_ = true;
+        return true;
+    }
+    void Disconnect() override {
+        connected_ = false;
+    }
+    int Send(const std::string& data) override {
+        return data.size();
+    }
+};
+
+static void MeasureSend(Udp& udp, const char* name, size_t packet_size, int count) {
+    std::string packet(packet_size, 'x');
+    CpuMeter meter;
+    meter.Start();
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < count; i++) {
+        if (udp.Send(packet) < 0) {
+            ESP_LOGE(TAG, "%s: send failed", name);
+            return;
+        }
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start;
+    meter.Stop();
+
+    ESP_LOGI(TAG, "%s %zu bytes: %.0f packets/s, %.2f us CPU per packet (CPU %.1f%%)", name, packet_size,
+        count * 1000000.0f / elapsed_us, (float)meter.busy_us() / count, meter.usage_percent());
+}
+
+void RunEncryptedUdpBenchmark() {
+    const int count = CONFIG_BENCHMARK_UDP_PACKETS;
+    // 60ms Opus 帧和接近 MTU 的数据报
+    const size_t sizes[] = {160, 1024, 1400};
+    const std::string key(16, 'k');
+    const std::string salt(ENCRYPTED_UDP_SALT_SIZE, 's');
+
+    NullUdp plain;
+    plain.Connect("0.0.0.0", 0);
+    EncryptedUdp encrypted(new NullUdp(), key, salt);
+    encrypted.Connect("0.0.0.0", 0);
+
+    for (auto size : sizes) {
+        // 未加密的结果是基准，差值即加密的代价
+        MeasureSend(plain, "Plain", size, count);
+        MeasureSend(encrypted, "AES-128-CTR", size, count);
+    }
+}
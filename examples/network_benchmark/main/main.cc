@@ -0,0 +1,60 @@
+#include "benchmark.h"
+
+#include <esp_log.h>
+#include <esp_netif.h>
+#include <esp_event.h>
+#include <nvs_flash.h>
+#include <protocol_examples_common.h>
+#include <sdkconfig.h>
+
+static const char *TAG = "Benchmark";
+
+#ifdef CONFIG_BENCHMARK_MQTT_THROUGHPUT
+static void RunCellularBenchmarks() {
+    Ml307AtModem modem(CONFIG_BENCHMARK_ML307_TX_PIN, CONFIG_BENCHMARK_ML307_RX_PIN, 2048);
+    modem.SetBaudRate(921600);
+    if (modem.WaitForNetworkReady() != 0) {
+        ESP_LOGE(TAG, "Cellular network not ready");
+        return;
+    }
+    ESP_LOGI(TAG, "Cellular IP Address: %s, CSQ: %d", modem.ip_address().c_str(), modem.GetCsq());
+
+    RunMqttThroughputBenchmark(modem);
+}
+#endif
+
+static void RunWifiBenchmarks() {
+    ESP_ERROR_CHECK(nvs_flash_init());
+    ESP_ERROR_CHECK(esp_netif_init());
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    if (example_connect() != ESP_OK) {
+        ESP_LOGE(TAG, "Wi-Fi not connected");
+        return;
+    }
+
+#ifdef CONFIG_BENCHMARK_TCP_LATENCY
+    RunTcpLatencyBenchmark();
+#endif
+#ifdef CONFIG_BENCHMARK_TLS_HANDSHAKE
+    RunTlsHandshakeBenchmark();
+#endif
+#ifdef CONFIG_BENCHMARK_TLS_CPU
+    RunTlsCpuBenchmark();
+#endif
+
+    example_disconnect();
+}
+
+extern "C" void app_main(void) {
+#ifdef CONFIG_BENCHMARK_ENCRYPTED_UDP
+    RunEncryptedUdpBenchmark();
+#endif
+
+#ifdef CONFIG_BENCHMARK_MQTT_THROUGHPUT
+    RunCellularBenchmarks();
+#endif
+
+    RunWifiBenchmarks();
+
+    ESP_LOGI(TAG, "All benchmarks finished");
+}
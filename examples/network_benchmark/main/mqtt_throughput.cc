@@ -0,0 +1,70 @@
+#include "benchmark.h"
+#include "ml307_mqtt.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <sdkconfig.h>
+#include <atomic>
+#include <string>
+
+static const char *TAG = "MqttBenchmark";
+
+#define MQTT_BENCHMARK_PAYLOAD_SIZE 64
+#define MQTT_BENCHMARK_TIMEOUT_MS 120000
+
+// 连续发布 count 条消息并等待全部完成回调，返回每秒完成的消息数，失败返回负数
+static float MeasureThroughput(Ml307Mqtt& mqtt, int qos, int count) {
+    std::string payload(MQTT_BENCHMARK_PAYLOAD_SIZE, 'x');
+    std::atomic<int> completed = 0;
+    std::atomic<int> failed = 0;
+    auto callback = [&completed, &failed](int message_id, bool success) {
+        if (!success) {
+            failed++;
+        }
+        completed++;
+    };
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < count; i++) {
+        // QoS1 窗口满时 PublishAsync 阻塞，测得的就是流水线的实际吞吐
+        if (mqtt.PublishAsync("benchmark/throughput", payload, qos, callback) < 0) {
+            failed++;
+            completed++;
+        }
+    }
+    while (completed < count && esp_timer_get_time() - start < MQTT_BENCHMARK_TIMEOUT_MS * 1000LL) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start;
+
+    if (completed < count || failed > 0) {
+        ESP_LOGE(TAG, "QoS%d: %d/%d completed, %d failed", qos, completed.load(), count, failed.load());
+        return -1;
+    }
+    return count * 1000000.0f / elapsed_us;
+}
+
+void RunMqttThroughputBenchmark(Ml307AtModem& modem) {
+    Ml307Mqtt mqtt(modem, 0);
+    mqtt.SetRawPublish(true);
+    if (!mqtt.Connect(CONFIG_BENCHMARK_MQTT_BROKER, CONFIG_BENCHMARK_MQTT_PORT, "ml307-benchmark", "", "")) {
+        ESP_LOGE(TAG, "Failed to connect to %s:%d", CONFIG_BENCHMARK_MQTT_BROKER, CONFIG_BENCHMARK_MQTT_PORT);
+        return;
+    }
+
+    const int count = CONFIG_BENCHMARK_MQTT_MESSAGES;
+    float rate = MeasureThroughput(mqtt, 0, count);
+    ESP_LOGI(TAG, "QoS0: %d messages x %d bytes, %.1f msg/s", count, MQTT_BENCHMARK_PAYLOAD_SIZE, rate);
+
+    // 窗口为 1 即原来的停等发布
+    const size_t windows[] = {1, 2, 4, 8};
+    for (auto window : windows) {
+        mqtt.SetPublishWindow(window);
+        rate = MeasureThroughput(mqtt, 1, count);
+        ESP_LOGI(TAG, "QoS1 window %zu: %d messages x %d bytes, %.1f msg/s", window, count, MQTT_BENCHMARK_PAYLOAD_SIZE, rate);
+    }
+
+    mqtt.Disconnect();
+}
@@ -0,0 +1,72 @@
+#include "benchmark.h"
+#include "tcp_transport.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <sdkconfig.h>
+#include <algorithm>
+#include <vector>
+
+static const char *TAG = "TcpLatencyBenchmark";
+
+// 长度前缀 + 负载，与实时音频帧大小相当
+#define TCP_BENCHMARK_FRAME_HEADER_SIZE 4
+#define TCP_BENCHMARK_FRAME_PAYLOAD_SIZE 60
+
+static bool ReceiveAll(TcpTransport& transport, char* buffer, size_t length) {
+    while (length > 0) {
+        int ret = transport.Receive(buffer, length);
+        if (ret <= 0) {
+            return false;
+        }
+        buffer += ret;
+        length -= ret;
+    }
+    return true;
+}
+
+static void MeasureEcho(bool no_delay, int count) {
+    TcpTransport transport;
+    transport.SetNoDelay(no_delay);
+    if (!transport.Connect(CONFIG_BENCHMARK_ECHO_HOST, CONFIG_BENCHMARK_TCP_ECHO_PORT)) {
+        ESP_LOGE(TAG, "Failed to connect to %s:%d", CONFIG_BENCHMARK_ECHO_HOST, CONFIG_BENCHMARK_TCP_ECHO_PORT);
+        return;
+    }
+
+    char header[TCP_BENCHMARK_FRAME_HEADER_SIZE] = {0, 0, 0, TCP_BENCHMARK_FRAME_PAYLOAD_SIZE};
+    char payload[TCP_BENCHMARK_FRAME_PAYLOAD_SIZE] = {};
+    char echo[TCP_BENCHMARK_FRAME_HEADER_SIZE + TCP_BENCHMARK_FRAME_PAYLOAD_SIZE];
+    std::vector<int64_t> rtts;
+    rtts.reserve(count);
+
+    for (int i = 0; i < count; i++) {
+        int64_t start = esp_timer_get_time();
+        // 头和负载分两次写入，Nagle 算法会把第二次写入留到第一段被确认之后
+        if (transport.Send(header, sizeof(header)) != sizeof(header)
+            || transport.Send(payload, sizeof(payload)) != sizeof(payload)
+            || !ReceiveAll(transport, echo, sizeof(echo))) {
+            ESP_LOGE(TAG, "Echo failed after %d frames", i);
+            break;
+        }
+        rtts.push_back(esp_timer_get_time() - start);
+    }
+    transport.Disconnect();
+    if (rtts.empty()) {
+        return;
+    }
+
+    std::sort(rtts.begin(), rtts.end());
+    int64_t sum = 0;
+    for (auto rtt : rtts) {
+        sum += rtt;
+    }
+    ESP_LOGI(TAG, "TCP_NODELAY %s: %zu frames, rtt avg %.2f ms, p50 %.2f ms, p99 %.2f ms, max %.2f ms",
+        no_delay ? "on" : "off", rtts.size(), sum / 1000.0f / rtts.size(), rtts[rtts.size() / 2] / 1000.0f,
+        rtts[rtts.size() * 99 / 100] / 1000.0f, rtts.back() / 1000.0f);
+}
+
+void RunTcpLatencyBenchmark() {
+    // 关闭 TCP_NODELAY 即改动前的行为
+    MeasureEcho(false, CONFIG_BENCHMARK_TCP_FRAMES);
+    MeasureEcho(true, CONFIG_BENCHMARK_TCP_FRAMES);
+}
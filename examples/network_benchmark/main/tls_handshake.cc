@@ -0,0 +1,66 @@
+#include "benchmark.h"
+#include "tls_transport.h"
+
+#include <esp_log.h>
+#include <sdkconfig.h>
+#include <algorithm>
+#include <vector>
+
+static const char *TAG = "TlsHandshakeBenchmark";
+
+static void Report(const char* name, std::vector<int64_t>& handshakes) {
+    if (handshakes.empty()) {
+        ESP_LOGE(TAG, "%s: no successful handshakes", name);
+        return;
+    }
+    std::sort(handshakes.begin(), handshakes.end());
+    int64_t sum = 0;
+    for (auto handshake : handshakes) {
+        sum += handshake;
+    }
+    ESP_LOGI(TAG, "%s: %zu handshakes, avg %d ms, min %d ms, max %d ms", name, handshakes.size(),
+        (int)(sum / 1000 / (int64_t)handshakes.size()), (int)(handshakes.front() / 1000), (int)(handshakes.back() / 1000));
+}
+
+// 连接 count 次，每次连接前是否清空会话缓存
+static void MeasureHandshakes(bool resume, int count) {
+    std::vector<int64_t> handshakes;
+    int offered = 0;
+    TlsTransport transport;
+    if (resume) {
+        // 第一次完整握手，取得服务器下发的会话
+        TlsTransport::ClearSessionCache();
+        if (!transport.Connect(CONFIG_BENCHMARK_TLS_HOST, CONFIG_BENCHMARK_TLS_PORT)) {
+            ESP_LOGE(TAG, "Failed to connect to %s:%d", CONFIG_BENCHMARK_TLS_HOST, CONFIG_BENCHMARK_TLS_PORT);
+            return;
+        }
+        transport.Disconnect();
+    }
+    for (int i = 0; i < count; i++) {
+        if (!resume) {
+            TlsTransport::ClearSessionCache();
+        }
+        if (!transport.Connect(CONFIG_BENCHMARK_TLS_HOST, CONFIG_BENCHMARK_TLS_PORT)) {
+            ESP_LOGE(TAG, "Failed to connect to %s:%d", CONFIG_BENCHMARK_TLS_HOST, CONFIG_BENCHMARK_TLS_PORT);
+            continue;
+        }
+        handshakes.push_back(transport.last_handshake_us());
+        if (transport.session_offered()) {
+            offered++;
+        }
+        transport.Disconnect();
+    }
+    Report(resume ? "With resumption" : "Full handshake", handshakes);
+    if (resume) {
+        // 服务器是否接受了会话只能从握手耗时判断
+        ESP_LOGI(TAG, "Session offered on %d of %d connections", offered, count);
+    }
+}
+
+void RunTlsHandshakeBenchmark() {
+#ifndef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    ESP_LOGW(TAG, "CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS is disabled, sessions are never resumed");
+#endif
+    MeasureHandshakes(false, CONFIG_BENCHMARK_TLS_HANDSHAKES);
+    MeasureHandshakes(true, CONFIG_BENCHMARK_TLS_HANDSHAKES);
+}
@@ -0,0 +1,102 @@
+#include "benchmark.h"
+#include "cpu_meter.h"
+#include "tls_transport.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <sdkconfig.h>
+#include <algorithm>
+#include <string>
+
+static const char *TAG = "TlsCpuBenchmark";
+
+#define TLS_BENCHMARK_CHUNK_SIZE 4096
+#define TLS_BENCHMARK_IDLE_RECEIVE_MS 5000
+
+static bool SendAll(TlsTransport& transport, const char* data, size_t length) {
+    while (length > 0) {
+        int ret = transport.Send(data, length);
+        if (ret <= 0) {
+            return false;
+        }
+        data += ret;
+        length -= ret;
+    }
+    return true;
+}
+
+// 持续上传时的吞吐和 CPU 占用；发送缓冲区满时 Send 应阻塞在 poll 上而不是空转
+static void MeasureUpload() {
+    TlsTransport transport;
+    if (!transport.Connect(CONFIG_BENCHMARK_TLS_UPLOAD_HOST, CONFIG_BENCHMARK_TLS_UPLOAD_PORT)) {
+        ESP_LOGE(TAG, "Failed to connect to %s:%d", CONFIG_BENCHMARK_TLS_UPLOAD_HOST, CONFIG_BENCHMARK_TLS_UPLOAD_PORT);
+        return;
+    }
+
+    const size_t total = CONFIG_BENCHMARK_TLS_UPLOAD_KB * 1024;
+    std::string request = "POST " CONFIG_BENCHMARK_TLS_UPLOAD_PATH " HTTP/1.1\r\n"
+        "Host: " CONFIG_BENCHMARK_TLS_UPLOAD_HOST "\r\n"
+        "Content-Type: application/octet-stream\r\n"
+        "Content-Length: " + std::to_string(total) + "\r\n"
+        "Connection: close\r\n\r\n";
+    if (!SendAll(transport, request.data(), request.size())) {
+        ESP_LOGE(TAG, "Failed to send request header");
+        return;
+    }
+
+    std::string chunk(TLS_BENCHMARK_CHUNK_SIZE, 'x');
+    CpuMeter meter;
+    meter.Start();
+    int64_t start = esp_timer_get_time();
+    size_t sent = 0;
+    while (sent < total) {
+        size_t length = std::min(chunk.size(), total - sent);
+        if (!SendAll(transport, chunk.data(), length)) {
+            ESP_LOGE(TAG, "Upload failed after %zu bytes", sent);
+            break;
+        }
+        sent += length;
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start;
+    meter.Stop();
+
+    ESP_LOGI(TAG, "Upload: %zu KB in %d ms, %.1f KB/s, CPU %.1f%%", sent / 1024, (int)(elapsed_us / 1000),
+        sent / 1024.0f * 1000000.0f / elapsed_us, meter.usage_percent());
+    transport.Disconnect();
+}
+
+// 连接空闲、没有数据可读时 Receive 的 CPU 占用，应接近空闲
+static void MeasureIdleReceive() {
+    TlsTransport transport;
+    if (!transport.Connect(CONFIG_BENCHMARK_TLS_UPLOAD_HOST, CONFIG_BENCHMARK_TLS_UPLOAD_PORT)) {
+        ESP_LOGE(TAG, "Failed to connect to %s:%d", CONFIG_BENCHMARK_TLS_UPLOAD_HOST, CONFIG_BENCHMARK_TLS_UPLOAD_PORT);
+        return;
+    }
+
+    char buffer[256];
+    int timeouts = 0;
+    CpuMeter meter;
+    meter.Start();
+    int64_t start = esp_timer_get_time();
+    while (esp_timer_get_time() - start < TLS_BENCHMARK_IDLE_RECEIVE_MS * 1000LL) {
+        int ret = transport.Receive(buffer, sizeof(buffer));
+        if (ret == TRANSPORT_RECEIVE_TIMEOUT) {
+            timeouts++;
+            continue;
+        }
+        if (ret <= 0) {
+            ESP_LOGE(TAG, "Connection closed while idle: %d", ret);
+            break;
+        }
+    }
+    meter.Stop();
+
+    ESP_LOGI(TAG, "Idle receive: %d ms, %d timeouts, CPU %.1f%%", (int)(meter.elapsed_us() / 1000), timeouts,
+        meter.usage_percent());
+    transport.Disconnect();
+}
+
+void RunTlsCpuBenchmark() {
+    MeasureIdleReceive();
+    MeasureUpload();
+}
@@ -0,0 +1,72 @@
+#ifndef DATAGRAM_POOL_H
+#define DATAGRAM_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+
+#define DATAGRAM_POOL_DEFAULT_COUNT 16
+#define DATAGRAM_POOL_DEFAULT_BUFFER_SIZE 1500
+
+class DatagramPool;
+
+// 数据报缓冲区句柄，带引用计数，最后一个句柄释放时缓冲区归还到池中
+class DatagramBuffer {
+public:
+    DatagramBuffer() = default;
+    DatagramBuffer(const DatagramBuffer& other);
+    DatagramBuffer(DatagramBuffer&& other) noexcept;
+    DatagramBuffer& operator=(const DatagramBuffer& other);
+    DatagramBuffer& operator=(DatagramBuffer&& other) noexcept;
+    ~DatagramBuffer() { Release(); }
+
+    char* data() const;
+    size_t size() const;
+    size_t capacity() const;
+    void set_size(size_t size);
+    void Release();
+    explicit operator bool() const { return pool_ != nullptr; }
+
+private:
+    friend class DatagramPool;
+    DatagramBuffer(std::shared_ptr<DatagramPool> pool, int index) : pool_(std::move(pool)), index_(index) {}
+
+    std::shared_ptr<DatagramPool> pool_;
+    int index_ = -1;
+};
+
+// 固定数量、固定大小的数据报缓冲池，接收路径上不再为每个数据报分配堆内存
+class DatagramPool : public std::enable_shared_from_this<DatagramPool> {
+public:
+    static std::shared_ptr<DatagramPool> Create(size_t count = DATAGRAM_POOL_DEFAULT_COUNT, size_t buffer_size = DATAGRAM_POOL_DEFAULT_BUFFER_SIZE);
+
+    // 池耗尽时返回空句柄
+    DatagramBuffer Acquire();
+    size_t buffer_size() const { return buffer_size_; }
+    size_t available();
+    // Acquire 失败的次数；接收方可能退回 OnMessage 交付，实际丢弃数见 Udp::dropped_count()
+    uint32_t exhausted_count() const { return exhausted_count_; }
+
+private:
+    friend class DatagramBuffer;
+
+    struct Slot {
+        std::atomic<int> ref_count;
+        size_t size;
+    };
+
+    size_t buffer_size_;
+    std::vector<char> storage_;
+    std::unique_ptr<Slot[]> slots_;
+    std::vector<int> free_slots_;
+    std::mutex mutex_;
+    std::atomic<uint32_t> exhausted_count_{0};
+
+    DatagramPool(size_t count, size_t buffer_size);
+    void Return(int index);
+};
+
+#endif // DATAGRAM_POOL_H
@@ -0,0 +1,77 @@
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include <string>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// getaddrinfo 不返回 TTL，使用固定的缓存时间
+#define DNS_CACHE_DEFAULT_TTL_SECONDS 300
+#define DNS_CACHE_DEFAULT_NEGATIVE_TTL_SECONDS 10
+// 剩余有效期低于该比例时后台刷新，期间继续返回旧地址
+#define DNS_CACHE_REFRESH_PERCENT 10
+// 解析结果至少保留这么久才允许 Invalidate，避免重连循环中每次失败都重新解析
+#define DNS_CACHE_MIN_INVALIDATE_INTERVAL_SECONDS 30
+
+struct DnsCacheStats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t negative_hits;
+    uint32_t prefetches;
+    // 最近一次未命中时的解析耗时
+    uint32_t last_resolve_us;
+};
+
+// 进程内共享的 DNS 缓存，线程安全；同一主机的并发解析会合并为一次
+class DnsCache {
+public:
+    static DnsCache& GetInstance() {
+        static DnsCache instance;
+        return instance;
+    }
+    DnsCache(const DnsCache&) = delete;
+    DnsCache& operator=(const DnsCache&) = delete;
+
+    void SetTtl(int ttl_seconds, int negative_ttl_seconds = DNS_CACHE_DEFAULT_NEGATIVE_TTL_SECONDS);
+    // 返回主机的全部地址（IPv4 和 IPv6，端口为 0），按 getaddrinfo 的顺序
+    // IP 字面量直接返回，不进入缓存
+    bool Resolve(const std::string& host, std::vector<struct sockaddr_storage>& addrs);
+    // 只需要 IPv4 的调用者使用，返回第一个 IPv4 地址
+    bool Resolve(const std::string& host, struct in_addr& addr);
+    // 在后台任务中解析，之后的 Resolve 直接命中
+    void Prefetch(const std::string& host);
+    // 连接缓存地址失败时调用，下次重新解析；刚解析不久的地址不会被丢弃
+    void Invalidate(const std::string& host);
+    void Clear();
+    DnsCacheStats GetStats();
+
+private:
+    struct Entry {
+        std::vector<struct sockaddr_storage> addrs;
+        int64_t resolved_at_us = 0;
+        int64_t expire_at_us = 0;
+        bool valid = false;
+        bool resolving = false;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::map<std::string, Entry> entries_;
+    int64_t ttl_us_ = DNS_CACHE_DEFAULT_TTL_SECONDS * 1000000LL;
+    int64_t negative_ttl_us_ = DNS_CACHE_DEFAULT_NEGATIVE_TTL_SECONDS * 1000000LL;
+    DnsCacheStats stats_ = {};
+
+    DnsCache() = default;
+    // 调用时不持有锁
+    bool Lookup(const std::string& host, std::vector<struct sockaddr_storage>& addrs);
+    void Update(const std::string& host, bool ok, const std::vector<struct sockaddr_storage>& addrs, int64_t resolve_us);
+    static bool ParseLiteral(const std::string& host, std::vector<struct sockaddr_storage>& addrs);
+    void StartPrefetch(const std::string& host);
+};
+
+#endif // DNS_CACHE_H
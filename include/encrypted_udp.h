@@ -0,0 +1,70 @@
+#ifndef ENCRYPTED_UDP_H
+#define ENCRYPTED_UDP_H
+
+#include "udp.h"
+
+#include <mbedtls/aes.h>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#define ENCRYPTED_UDP_SALT_SIZE 8
+// 每个数据报前的明文头：会话号(4) + 序号(4)，大端，参与生成计数器块
+#define ENCRYPTED_UDP_HEADER_SIZE 8
+// 计数器块第 12 字节的最高位区分方向，数据报不超过 64KB，块计数用不到这一位
+#define ENCRYPTED_UDP_DIRECTION_UPLINK 0x00
+#define ENCRYPTED_UDP_DIRECTION_DOWNLINK 0x80
+
+// 客户端发送上行、接收下行；服务端相反。两端必须使用相反的角色
+enum class EncryptedUdpRole {
+    Client,
+    Server,
+};
+
+// AES-CTR 加密的 UDP：发送时直接加密到复用的发送缓冲区，接收时原地解密
+// 计数器块 = (salt(8) 前 4 字节异或会话号) + 序号(4) + 方向(1 bit) + 块计数
+// 每次 Connect 用硬件随机数生成新的会话号，序号从 0 开始，序号回绕时更换会话号，
+// 同一密钥下不会重复使用计数器块
+// 芯片开启 CONFIG_MBEDTLS_HARDWARE_AES 时 mbedtls 使用硬件 AES
+//
+// 注意：只加密，不做完整性校验。CTR 密文被篡改后照样能"解密"出被改动的明文，
+// 也不防重放（序号只用于生成计数器块，不做去重）。需要防篡改时由上层协议自带校验，
+// 或改用 DTLS 等带认证的传输
+class EncryptedUdp : public Udp {
+public:
+    // 接管 udp 的所有权，析构时一并删除；key 长度为 16/24/32 字节，salt 为 8 字节
+    EncryptedUdp(Udp* udp, const std::string& key, const std::string& salt, EncryptedUdpRole role = EncryptedUdpRole::Client);
+    ~EncryptedUdp();
+
+    bool Connect(const std::string& host, int port) override;
+    void Disconnect() override;
+    int Send(const std::string& data) override;
+    void OnMessage(std::function<void(const std::string& data)> callback) override;
+    void OnMessageBuffer(std::function<void(DatagramBuffer buffer)> callback) override;
+
+    uint32_t decrypt_failures() const { return decrypt_failures_; }
+
+private:
+    Udp* udp_;
+    uint8_t salt_[ENCRYPTED_UDP_SALT_SIZE];
+    uint8_t send_direction_;
+    uint8_t receive_direction_;
+    bool key_valid_ = false;
+
+    // 发送和接收在不同任务中进行，各用一份 AES 上下文和缓冲区，由各自的锁保护
+    std::mutex send_mutex_;
+    mbedtls_aes_context send_aes_;
+    uint32_t send_session_ = 0;
+    uint32_t send_sequence_ = 0;
+    std::string send_buffer_;
+
+    std::mutex receive_mutex_;
+    mbedtls_aes_context receive_aes_;
+    std::string receive_buffer_;
+    std::atomic<uint32_t> decrypt_failures_{0};
+
+    void Crypt(mbedtls_aes_context* aes, uint32_t session, uint32_t sequence, uint8_t direction, const char* input, char* output, size_t length);
+};
+
+#endif // ENCRYPTED_UDP_H
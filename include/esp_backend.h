@@ -0,0 +1,20 @@
+#ifndef ESP_BACKEND_H
+#define ESP_BACKEND_H
+
+#include "network_backend.h"
+
+// 使用 lwIP/esp-tls 的原生网络（通常是 Wi-Fi）
+class EspBackend : public NetworkBackend {
+public:
+    const char* name() const override { return "esp"; }
+    // 默认网卡已启动并获得 IP
+    bool IsReady() override;
+
+    Transport* CreateTlsTransport() override;
+    Http* CreateHttp() override;
+    Mqtt* CreateMqtt() override;
+    Udp* CreateUdp() override;
+    UdpEndpoint* CreateUdpEndpoint() override;
+};
+
+#endif // ESP_BACKEND_H
@@ -3,9 +3,17 @@
 
 #include "http.h"
 #include <esp_http_client.h>
+#include <esp_timer.h>
 
 #include <string>
 #include <map>
+#include <mutex>
+#include <cstdint>
+
+// 空闲连接保留时间，超过后由定时器关闭连接
+#define HTTP_DEFAULT_IDLE_TIMEOUT_MS 30000
+// GetBody 最多读入内存的响应体大小，更大的响应应使用 Read 流式读取
+#define HTTP_DEFAULT_MAX_BODY_SIZE (64 * 1024)
 
 class EspHttp : public Http {
 public:
@@ -22,13 +30,45 @@ public:
     const std::string& GetBody() override;
     int Read(char* buffer, size_t buffer_size) override;
 
+    // 保持连接：同一 scheme/host/port 的后续请求复用已建立的 TCP/TLS 连接
+    void SetKeepAlive(bool enable, int idle_timeout_ms = HTTP_DEFAULT_IDLE_TIMEOUT_MS);
+    void SetMaxBodySize(size_t max_body_size);
+
+    // 流式上传：OpenStream 后多次 Write 分块发送请求体，FinishStream 结束请求并读取响应头
+    bool OpenStream(const std::string& method, const std::string& url);
+    int Write(const char* data, size_t length);
+    bool FinishStream();
+
 private:
     esp_http_client_handle_t client_;
+    bool keep_alive_ = true;
+    int idle_timeout_ms_ = HTTP_DEFAULT_IDLE_TIMEOUT_MS;
+    // 当前连接的 scheme://host:port
+    std::string origin_;
+    int64_t last_used_us_ = 0;
+    // 空闲连接到期后在 esp_timer 任务中关闭，所有访问 client_ 的公开方法都持有 client_mutex_
+    esp_timer_handle_t idle_timer_ = nullptr;
+    // 定时器回调通过 id 查找实例，实例析构后回调找不到它，不会访问已释放的对象
+    uint32_t timer_id_ = 0;
+    mutable std::mutex client_mutex_;
+    bool idle_ = false;
+    size_t max_body_size_ = HTTP_DEFAULT_MAX_BODY_SIZE;
     std::map<std::string, std::string> headers_;
     std::string response_body_;
     int status_code_;
     int64_t content_length_;
 
+    static std::string GetOrigin(const std::string& url);
+    bool InitClient(const std::string& url);
+    bool OpenRequest(const std::string& method, const std::string& url, int write_length);
+    bool FetchResponse();
+    void SetupRequest(const std::string& method);
+    int ReadLocked(char* buffer, size_t buffer_size);
+    void ReleaseClient();
+    // 以下两个方法要求调用者已持有 client_mutex_
+    void StartIdleTimer();
+    void StopIdleTimer();
+    static void OnIdleTimer(void* arg);
     static esp_err_t HttpEventHandler(esp_http_client_event_t *evt);
 };
 
@@ -2,6 +2,7 @@
 #define ESP_MQTT_H
 
 #include "mqtt.h"
+#include "mqtt_message_assembler.h"
 
 #include <mqtt_client.h>
 #include <freertos/FreeRTOS.h>
@@ -9,6 +10,9 @@
 #include <freertos/event_groups.h>
 #include <string>
 #include <functional>
+#include <mutex>
+#include <vector>
+#include <map>
 
 #define MQTT_CONNECT_TIMEOUT_MS 10000
 
@@ -16,19 +20,52 @@
 #define MQTT_CONNECTED_EVENT BIT1
 #define MQTT_DISCONNECTED_EVENT BIT2
 #define MQTT_ERROR_EVENT BIT3
+#define MQTT_SUBSCRIBED_EVENT BIT6
+
+#define MQTT_SUBSCRIBE_TIMEOUT_MS 5000
+
+enum class MqttTransport {
+    // 与旧版本一致：8883 使用 SSL，其他端口使用 WS；需要 TCP/WSS 时显式指定
+    Auto,
+    Tcp,
+    Ssl,
+    Ws,
+    Wss,
+};
+
+// 0 表示使用 esp-mqtt 的默认值
+struct EspMqttConfig {
+    MqttTransport transport = MqttTransport::Auto;
+    // 仅 WS/WSS 使用
+    std::string path = "/mqtt";
+    int buffer_size = 0;
+    int out_buffer_size = 0;
+    // outbox 中待确认消息占用的最大字节数
+    int outbox_limit = 0;
+    int task_priority = 0;
+    int task_stack_size = 0;
+};
 
 class EspMqtt : public Mqtt {
 public:
     EspMqtt();
     ~EspMqtt();
 
-    bool Connect(const std::string broker_address, int broker_port, const std::string client_id, const std::string username, const std::string password);
+    bool Connect(const std::string& broker_address, int broker_port, const std::string& client_id, const std::string& username, const std::string& password);
     void Disconnect();
-    bool Publish(const std::string topic, const std::string payload, int qos = 0);
-    bool Subscribe(const std::string topic, int qos = 0);
-    bool Unsubscribe(const std::string topic);
+    bool Publish(std::string_view topic, std::string_view payload, int qos = 0);
+    bool Subscribe(const std::string& topic, int qos = 0);
+    using Mqtt::Subscribe;
+    bool SubscribeMultiple(std::vector<MqttSubscription>& subscriptions) override;
+    bool Unsubscribe(const std::string& topic);
     bool IsConnected();
 
+    // 在 Connect 之前调用
+    void SetConfig(const EspMqttConfig& config) { config_ = config; }
+
+    // 分段消息重组的最大长度，超出的消息被丢弃
+    void SetMaxMessageSize(size_t max_message_size) { assembler_.SetMaxMessageSize(max_message_size); }
+
 private:
     bool connected_ = false;
     EventGroupHandle_t event_group_handle_;
@@ -37,9 +74,17 @@ private:
     std::string client_id_;
     std::string username_;
     std::string password_;
-    std::string message_payload_;
+    EspMqttConfig config_;
+    MqttMessageAssembler assembler_;
     esp_mqtt_client_handle_t mqtt_client_handle_ = nullptr;
 
+    // 同一时间只有一个 SubscribeMultiple 等待 SUBACK
+    std::mutex subscribe_mutex_;
+    std::mutex suback_mutex_;
+    bool subscribing_ = false;
+    // 按报文 ID 保存的 SUBACK 返回码
+    std::map<int, std::vector<int>> suback_results_;
+
     void MqttEventCallback(esp_event_base_t base, int32_t event_id, void *event_data);
 };
 
@@ -5,22 +5,59 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
-#include <thread>
+#include <freertos/task.h>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+#define ESP_UDP_RECEIVE_TASK_EXIT BIT0
+
+// 接收任务每次 select 的超时，决定 Disconnect 最长等待时间
+#define ESP_UDP_SELECT_TIMEOUT_MS 100
+// 每次唤醒最多连续读取的数据报数量
+#define ESP_UDP_MAX_BATCH 16
+
+struct UdpReceiveStats {
+    uint32_t wakeups;
+    uint32_t datagrams;
+    uint32_t max_batch;
+    // 缓冲池耗尽且没有 OnMessage 可退回而丢弃的数据报，同 dropped_count()
+    uint32_t dropped;
+    // 从 select 返回可读到数据报交给回调的延迟，反映同一批中排在后面的数据报等待前面回调的时间
+    // 不包含数据报在协议栈中排队的时间
+    uint32_t average_latency_us;
+    uint32_t max_latency_us;
+};
 
 class EspUdp : public Udp {
 public:
     EspUdp();
     ~EspUdp();
 
+    // 在 Connect 之前调用，core 为 tskNO_AFFINITY 时不绑定核心
+    void SetReceiveTask(int priority, int core = tskNO_AFFINITY, int stack_size = 4096);
     bool Connect(const std::string& host, int port) override;
     void Disconnect() override;
     int Send(const std::string& data) override;
+    UdpReceiveStats GetReceiveStats();
 
 private:
     int udp_fd_;
-    std::thread receive_thread_;
+    EventGroupHandle_t event_group_handle_;
+    TaskHandle_t receive_task_handle_ = nullptr;
+    std::atomic<bool> stopping_{false};
+    int task_priority_ = 5;
+    int task_core_ = tskNO_AFFINITY;
+    int task_stack_size_ = 4096;
+    std::string receive_buffer_;
+
+    std::mutex stats_mutex_;
+    UdpReceiveStats receive_stats_ = {};
+    uint64_t total_latency_us_ = 0;
 
     void ReceiveTask();
+    // 非阻塞读完当前所有待收的数据报，返回 false 表示套接字出错
+    bool DrainSocket(int64_t ready_time);
 };
 
 #endif // ESP_UDP_H
@@ -0,0 +1,34 @@
+#ifndef ESP_UDP_ENDPOINT_H
+#define ESP_UDP_ENDPOINT_H
+
+#include "udp_endpoint.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/task.h>
+#include <atomic>
+
+#define ESP_UDP_ENDPOINT_RECEIVE_TASK_EXIT BIT0
+// 接收任务 select 的超时，用于及时发现 Close
+#define ESP_UDP_ENDPOINT_SELECT_TIMEOUT_MS 100
+
+// 只支持 IPv4：绑定 INADDR_ANY，SendTo 的域名解析为 IPv4 地址，IPv6 字面地址会发送失败
+class EspUdpEndpoint : public UdpEndpoint {
+public:
+    EspUdpEndpoint();
+    ~EspUdpEndpoint();
+
+    bool Bind(int local_port = 0) override;
+    void Close() override;
+    int SendTo(const std::string& host, int port, const std::string& data) override;
+
+private:
+    int udp_fd_ = -1;
+    EventGroupHandle_t event_group_handle_;
+    TaskHandle_t receive_task_handle_ = nullptr;
+    std::atomic<bool> stopping_{false};
+
+    void ReceiveTask();
+};
+
+#endif // ESP_UDP_ENDPOINT_H
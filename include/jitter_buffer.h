@@ -0,0 +1,79 @@
+#ifndef JITTER_BUFFER_H
+#define JITTER_BUFFER_H
+
+#include "udp.h"
+#include "datagram_pool.h"
+
+#include <map>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+
+#define JITTER_BUFFER_DEFAULT_FRAME_MS 60
+#define JITTER_BUFFER_DEFAULT_MIN_DELAY_MS 60
+#define JITTER_BUFFER_DEFAULT_MAX_DELAY_MS 600
+#define JITTER_BUFFER_DEFAULT_CAPACITY 12
+
+struct JitterBufferStats {
+    uint32_t received;
+    uint32_t played;
+    // 网络丢包数：按 RFC 3550 A.3 由序号范围推算的应收数减去实收数，迟到的包不算丢失
+    uint32_t lost;
+    // 播放时该帧缺失、由解码器做丢包补偿的次数
+    uint32_t concealed;
+    uint32_t late;
+    uint32_t duplicate;
+    // 缓冲区空了需要重新缓冲的次数
+    uint32_t underrun;
+    // 积压超过目标延迟或容量时主动丢弃的包
+    uint32_t discarded;
+    uint32_t jitter_ms;
+    uint32_t target_delay_ms;
+    uint32_t buffered_ms;
+};
+
+// 音频抖动缓冲：按序号重排、检测丢包、去重，播放延迟随测得的抖动（RFC 3550）自适应
+class JitterBuffer {
+public:
+    // 从数据报中取出 16 位序号，返回 false 表示不是有效的媒体包
+    typedef std::function<bool(const char* data, size_t length, uint16_t& sequence)> SequenceExtractor;
+
+    JitterBuffer(int frame_duration_ms = JITTER_BUFFER_DEFAULT_FRAME_MS,
+        int min_delay_ms = JITTER_BUFFER_DEFAULT_MIN_DELAY_MS,
+        int max_delay_ms = JITTER_BUFFER_DEFAULT_MAX_DELAY_MS,
+        size_t capacity = JITTER_BUFFER_DEFAULT_CAPACITY);
+
+    // 接管 udp 的 OnMessageBuffer 回调，数据报以池化缓冲区形式保存，不再复制
+    void Attach(Udp& udp, SequenceExtractor extractor);
+    void Push(uint16_t sequence, DatagramBuffer buffer);
+    // 播放端每帧调用一次；返回 false 时本帧没有数据（丢包或正在缓冲），由解码器做丢包补偿
+    bool Pop(DatagramBuffer& buffer);
+    void Reset();
+    JitterBufferStats GetStats();
+
+private:
+    int64_t frame_duration_us_;
+    int64_t min_delay_us_;
+    int64_t max_delay_us_;
+    size_t capacity_;
+
+    std::mutex mutex_;
+    std::map<uint32_t, DatagramBuffer> packets_;
+    bool has_sequence_ = false;
+    // 收到的最小扩展序号，与最高序号一起推算应收包数
+    uint32_t base_sequence_ = 0;
+    uint32_t highest_sequence_ = 0;
+    uint32_t next_sequence_ = 0;
+    bool playing_ = false;
+    int64_t buffering_start_us_ = 0;
+    bool has_transit_ = false;
+    int64_t last_transit_us_ = 0;
+    // RFC 3550 抖动估计，单位微秒，放大 16 倍保存以保留精度
+    int64_t jitter_us_x16_ = 0;
+    JitterBufferStats stats_ = {};
+
+    uint32_t ExtendSequence(uint16_t sequence);
+    int64_t TargetDelayUs() const;
+};
+
+#endif // JITTER_BUFFER_H
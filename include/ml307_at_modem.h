@@ -7,6 +7,7 @@
 #include <list>
 #include <functional>
 #include <mutex>
+#include <atomic>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/queue.h>
@@ -22,6 +23,7 @@
 #define DEFAULT_COMMAND_TIMEOUT 3000
 #define DEFAULT_BAUD_RATE 115200
 #define DEFAULT_UART_NUM UART_NUM_1
+#define RAW_DATA_CHUNK_SIZE 1024
 
 struct AtArgumentValue {
     enum class Type {
@@ -46,8 +48,12 @@ public:
     std::string DecodeHex(const std::string& data);
     void EncodeHexAppend(std::string& dest, const char* data, size_t length);
     void DecodeHexAppend(std::string& dest, const char* data, size_t length);
+    // 解码到调用者提供的缓冲区，返回写入的字节数（最多 dest_size）
+    size_t DecodeHexTo(char* dest, size_t dest_size, const char* data, size_t length);
 
     bool Command(const std::string command, int timeout_ms = DEFAULT_COMMAND_TIMEOUT);
+    // 发送命令，等待 ">" 提示符后分块写入原始数据，再等待 OK
+    bool CommandWithData(const std::string& command, const char* data, size_t length, int timeout_ms = DEFAULT_COMMAND_TIMEOUT);
     std::list<CommandResponseCallback>::iterator RegisterCommandResponseCallback(CommandResponseCallback callback);
     void UnregisterCommandResponseCallback(std::list<CommandResponseCallback>::iterator iterator);
 
@@ -73,6 +79,8 @@ private:
     std::mutex command_mutex_;
     bool debug_ = false;
     bool network_ready_ = false;
+    // 只有 CommandWithData 等待 "> " 时才把行首的 '>' 当作提示符
+    std::atomic<bool> data_prompt_pending_ = false;
     std::string ip_address_;
     std::string iccid_;
     std::string carrier_name_;
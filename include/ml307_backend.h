@@ -0,0 +1,49 @@
+#ifndef ML307_BACKEND_H
+#define ML307_BACKEND_H
+
+#include "network_backend.h"
+#include "ml307_at_modem.h"
+
+#include <mutex>
+#include <memory>
+#include <vector>
+
+// 模组同时支持的 socket 连接数，TCP/SSL/UDP 共用连接 ID
+#define ML307_MAX_CONNECTIONS 6
+#define ML307_MAX_MQTT_CONNECTIONS 2
+
+// 模组连接 ID 池：对象析构时归还 ID。由 shared_ptr 持有，创建的对象可以比后端活得久
+class Ml307IdPool {
+public:
+    Ml307IdPool(int size) : used_(size, false) {}
+    // 没有空闲 ID 时返回 -1
+    int Acquire();
+    void Release(int id);
+
+private:
+    std::mutex mutex_;
+    std::vector<bool> used_;
+};
+
+// ID 用完时 Create* 返回 nullptr（CreateHttp 不占用连接 ID）
+// UDP 服务模式的 AT 指令尚未在固件上验证，CreateUdpEndpoint 暂时返回 nullptr；需要时可直接试用 Ml307UdpEndpoint
+class Ml307Backend : public NetworkBackend {
+public:
+    Ml307Backend(Ml307AtModem& modem);
+
+    const char* name() const override { return "ml307"; }
+    bool IsReady() override;
+
+    Transport* CreateTlsTransport() override;
+    Http* CreateHttp() override;
+    Mqtt* CreateMqtt() override;
+    Udp* CreateUdp() override;
+    UdpEndpoint* CreateUdpEndpoint() override;
+
+private:
+    Ml307AtModem& modem_;
+    std::shared_ptr<Ml307IdPool> connection_ids_;
+    std::shared_ptr<Ml307IdPool> mqtt_ids_;
+};
+
+#endif // ML307_BACKEND_H
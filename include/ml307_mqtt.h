@@ -2,6 +2,7 @@
 #define ML307_MQTT_H
 
 #include "mqtt.h"
+#include "mqtt_message_assembler.h"
 
 #include "ml307_at_modem.h"
 #include <freertos/FreeRTOS.h>
@@ -9,40 +10,144 @@
 #include <freertos/event_groups.h>
 #include <string>
 #include <functional>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #define MQTT_CONNECT_TIMEOUT_MS 10000
+#define MQTT_PUBLISH_TIMEOUT_MS 5000
+#define MQTT_PUBLISH_MAX_RETRIES 3
+#define MQTT_DEFAULT_PUBLISH_WINDOW 4
+#define MQTT_SUBSCRIBE_TIMEOUT_MS 5000
+// 单条 AT+MQTTSUB 可携带的过滤器数量（未在所有固件上验证，模组拒绝时自动退回单主题订阅）
+#define MQTT_MAX_TOPICS_PER_SUBSCRIBE 4
 
 #define MQTT_INITIALIZED_EVENT BIT0
 #define MQTT_CONNECTED_EVENT BIT1
 #define MQTT_DISCONNECTED_EVENT BIT2
+#define MQTT_WORKER_WAKE_EVENT BIT3
+#define MQTT_WORKER_EXIT_EVENT BIT4
+#define MQTT_SUBACK_EVENT BIT5
+
+// 发布完成回调：QoS0 在模组接受后回调，QoS1 在收到 PUBACK 或重试耗尽后回调
+// 回调在 MQTT worker 任务中执行，不持有内部锁，可以在回调里继续发布
+typedef std::function<void(int message_id, bool success)> MqttPublishCallback;
 
 class Ml307Mqtt : public Mqtt {
 public:
     Ml307Mqtt(Ml307AtModem& modem, int mqtt_id);
     ~Ml307Mqtt();
 
-    bool Connect(const std::string broker_address, int broker_port, const std::string client_id, const std::string username, const std::string password);
+    bool Connect(const std::string& broker_address, int broker_port, const std::string& client_id, const std::string& username, const std::string& password);
     void Disconnect();
-    bool Publish(const std::string topic, const std::string payload, int qos = 0);
-    bool Subscribe(const std::string topic, int qos = 0);
-    bool Unsubscribe(const std::string topic);
+    // QoS1 时与 PublishAsync 共用发送窗口，窗口已满会阻塞最多 publish_timeout_ms 等待空位
+    bool Publish(std::string_view topic, std::string_view payload, int qos = 0);
+    bool Subscribe(const std::string& topic, int qos = 0);
+    using Mqtt::Subscribe;
+    bool SubscribeMultiple(std::vector<MqttSubscription>& subscriptions) override;
+    bool Unsubscribe(const std::string& topic);
+    // 立即返回由 URC 维护的连接状态
     bool IsConnected();
+    // 向模组查询连接状态（AT+MQTTSTATE），会阻塞直到模组响应
+    bool Refresh();
+
+    // 原始数据发布：先声明长度，等待 ">" 后直接写入负载，避免 HEX 编码带来的双倍流量
+    // 已连接时会重新配置模组的 encoding，配置失败返回 false 并保持原来的模式
+    bool SetRawPublish(bool enable);
+    // 分段消息重组的最大长度，超出的消息被丢弃
+    void SetMaxMessageSize(size_t max_message_size) { assembler_.SetMaxMessageSize(max_message_size); }
+
+    // QoS1 发布流水线：最多 window 条消息同时等待 PUBACK
+    void SetPublishWindow(size_t window);
+    void SetPublishRetry(int timeout_ms, int max_retries);
+    // 返回本地消息 ID，失败返回 -1；QoS1 窗口已满时最多阻塞 publish_timeout_ms
+    // 断线时未确认的 QoS1 消息：clean session 下回调失败，持久会话下保留并在重连后重传
+    int PublishAsync(std::string_view topic, std::string_view payload, int qos = 0, MqttPublishCallback callback = nullptr);
+    size_t GetInFlightCount();
 
 private:
+    struct InFlightMessage {
+        int message_id;
+        std::string topic;
+        std::string payload;
+        int qos;
+        int retries;
+        TickType_t sent_tick;
+        MqttPublishCallback callback;
+        // 模组为每次发送分配的报文 ID，重发会得到新的 ID，任一 ID 的 PUBACK 都表示完成
+        std::vector<int> packet_ids;
+        bool sent;
+    };
+
+    struct PublishCompletion {
+        int message_id;
+        bool success;
+        MqttPublishCallback callback;
+    };
+
     Ml307AtModem& modem_;
     int mqtt_id_;
-    bool connected_ = false;
+    // 以下标志在 URC 回调、worker 任务和调用者任务之间共享
+    std::atomic<bool> connected_ = false;
+    std::atomic<bool> connecting_ = false;
+    std::atomic<bool> raw_publish_ = false;
+    std::atomic<bool> user_disconnect_ = false;
+    std::atomic<bool> reconnect_pending_ = false;
+    std::atomic<bool> resubscribe_pending_ = false;
+    // URC 回调中不能调用用户回调（回调里可能发送 AT 命令），交给 worker 执行
+    std::atomic<bool> connected_callback_pending_ = false;
+    std::atomic<bool> disconnected_callback_pending_ = false;
+    int reconnect_backoff_ms_ = MQTT_RECONNECT_MIN_BACKOFF_MS;
+    TickType_t next_reconnect_tick_ = 0;
     EventGroupHandle_t event_group_handle_;
     std::string broker_address_;
     int broker_port_ = 1883;
     std::string client_id_;
     std::string username_;
     std::string password_;
-    std::string message_payload_;
+    MqttMessageAssembler assembler_;
+
+    std::mutex send_mutex_;
+    std::mutex publish_mutex_;
+    std::condition_variable publish_cv_;
+    std::deque<InFlightMessage> in_flight_;
+    // 完成回调在 worker 任务中、不持有任何锁时调用
+    std::deque<PublishCompletion> completions_;
+    // 正在发送的消息，用于关联 +MQTTPUB 返回的报文 ID
+    int sending_message_id_ = -1;
+    // 模组是否在 +MQTTPUB 中上报报文 ID
+    bool packet_ids_reported_ = false;
+    size_t publish_window_ = MQTT_DEFAULT_PUBLISH_WINDOW;
+    int publish_timeout_ms_ = MQTT_PUBLISH_TIMEOUT_MS;
+    int max_publish_retries_ = MQTT_PUBLISH_MAX_RETRIES;
+    int next_message_id_ = 1;
+    std::atomic<bool> stopping_ = false;
+    TaskHandle_t worker_task_handle_ = nullptr;
+
+    std::mutex subscribe_mutex_;
+    // 订阅期间收到的 SUBACK 结果，按报文 ID 保存，由 URC 回调写入
+    std::mutex suback_mutex_;
+    std::map<int, std::vector<int>> suback_results_;
+    bool subscribing_ = false;
+    // AT+MQTTSUB 返回的报文 ID，-1 表示模组未上报
+    int subscribe_msg_id_ = -1;
+    std::atomic<bool> multi_topic_subscribe_ = true;
 
     std::list<CommandResponseCallback>::iterator command_callback_it_;
 
     std::string ErrorToString(int error_code);
+    bool ConnectInternal();
+    bool SendPublish(int message_id, std::string_view topic, std::string_view payload, int qos);
+    void OnPublishSent(int packet_id);
+    void OnPublishAcknowledged(int packet_id);
+    void FailInFlightMessages();
+    void RunCompletions();
+    void RetransmitExpiredMessages();
+    void Resubscribe();
+    bool SendSubscribe(const std::vector<MqttSubscription>& subscriptions, size_t start, size_t end, int& msg_id);
+    void TryReconnect();
+    void WorkerTask();
 };
 
 #endif
\ No newline at end of file
@@ -6,6 +6,9 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 
 #define ML307_UDP_CONNECTED BIT0
 #define ML307_UDP_DISCONNECTED BIT1
@@ -13,8 +16,26 @@
 #define ML307_UDP_RECEIVE BIT3
 #define ML307_UDP_SEND_COMPLETE BIT4
 #define ML307_UDP_INITIALIZED BIT5
+#define ML307_UDP_SEND_TASK_EXIT BIT6
 
 #define UDP_CONNECT_TIMEOUT_MS 10000
+#define UDP_DEFAULT_SEND_QUEUE_DEPTH 16
+
+// 发送队列满时的处理策略
+enum class UdpOverflowPolicy {
+    DropOldest,
+    DropNewest,
+};
+
+struct UdpSendStats {
+    uint32_t sent;
+    uint32_t dropped;
+    uint32_t failed;
+    uint32_t queued;
+    // 从入队到模组返回 OK 的延迟
+    uint32_t average_latency_us;
+    uint32_t max_latency_us;
+};
 
 class Ml307Udp : public Udp {
 public:
@@ -25,11 +46,35 @@ public:
     void Disconnect() override;
     int Send(const std::string& data) override;
 
+    // 启用异步发送：Send 只入队立即返回，由发送任务写入模组；任务创建失败返回 false，Send 保持同步发送
+    bool EnableSendQueue(size_t depth = UDP_DEFAULT_SEND_QUEUE_DEPTH, UdpOverflowPolicy policy = UdpOverflowPolicy::DropOldest, int task_priority = 5);
+    UdpSendStats GetSendStats();
+
 private:
+    struct QueuedDatagram {
+        std::string data;
+        int64_t enqueue_time_us;
+    };
+
     Ml307AtModem& modem_;
     int udp_id_;
     EventGroupHandle_t event_group_handle_;
     std::list<CommandResponseCallback>::iterator command_callback_it_;
+
+    std::mutex send_mutex_;
+    std::condition_variable send_cv_;
+    std::deque<QueuedDatagram> send_queue_;
+    size_t send_queue_depth_ = 0;
+    UdpOverflowPolicy overflow_policy_ = UdpOverflowPolicy::DropOldest;
+    TaskHandle_t send_task_handle_ = nullptr;
+    bool stopping_ = false;
+    // 发送任务复用的命令缓冲区
+    std::string send_command_;
+    UdpSendStats send_stats_ = {};
+    uint64_t total_latency_us_ = 0;
+
+    int SendNow(std::string& command, const char* data, size_t length);
+    void SendTask();
 };
 
 #endif // ML307_UDP_H
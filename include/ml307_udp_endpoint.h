@@ -0,0 +1,34 @@
+#ifndef ML307_UDP_ENDPOINT_H
+#define ML307_UDP_ENDPOINT_H
+
+#include "udp_endpoint.h"
+#include "ml307_at_modem.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+#define ML307_UDP_ENDPOINT_OPENED BIT0
+#define ML307_UDP_ENDPOINT_CLOSED BIT1
+#define ML307_UDP_ENDPOINT_ERROR BIT2
+
+#define UDP_ENDPOINT_OPEN_TIMEOUT_MS 10000
+
+// 使用模组的 UDP 服务模式，一个连接 ID 即可收发任意对端
+// 实验性：UDP SERVICE 的 AT 指令格式（见 ml307_udp_endpoint.cc）尚未在 ML307 固件上验证，接口可能变化
+class Ml307UdpEndpoint : public UdpEndpoint {
+public:
+    Ml307UdpEndpoint(Ml307AtModem& modem, int udp_id);
+    ~Ml307UdpEndpoint();
+
+    bool Bind(int local_port = 0) override;
+    void Close() override;
+    int SendTo(const std::string& host, int port, const std::string& data) override;
+
+private:
+    Ml307AtModem& modem_;
+    int udp_id_;
+    EventGroupHandle_t event_group_handle_;
+    std::list<CommandResponseCallback>::iterator command_callback_it_;
+};
+
+#endif // ML307_UDP_ENDPOINT_H
@@ -2,29 +2,157 @@
 #define MQTT_INTERFACE_H
 
 #include <string>
+#include <string_view>
 #include <functional>
+#include <mutex>
+#include <vector>
+#include <map>
+
+#include "mqtt_topic_trie.h"
+
+#define MQTT_RECONNECT_MIN_BACKOFF_MS 1000
+#define MQTT_RECONNECT_MAX_BACKOFF_MS 60000
+
+#define MQTT_SUBACK_FAILURE 0x80
+
+struct MqttSubscription {
+    std::string filter;
+    int qos;
+    // SUBACK 返回的授权 QoS，失败为 MQTT_SUBACK_FAILURE，未收到 SUBACK 为 -1
+    int granted_qos = -1;
+};
 
 class Mqtt {
 public:
     virtual ~Mqtt() {}
 
     void SetKeepAlive(int keep_alive_seconds) { keep_alive_seconds_ = keep_alive_seconds; }
-    virtual bool Connect(const std::string broker_address, int broker_port, const std::string client_id, const std::string username, const std::string password) = 0;
+    // clean_session = false 时使用持久会话，断线期间服务器为我们保留 QoS1 消息
+    void SetCleanSession(bool clean_session) { clean_session_ = clean_session; }
+    // 服务器断开后按指数退避自动重连，并重新订阅之前的主题
+    void SetAutoReconnect(bool enable, int min_backoff_ms = MQTT_RECONNECT_MIN_BACKOFF_MS, int max_backoff_ms = MQTT_RECONNECT_MAX_BACKOFF_MS) {
+        auto_reconnect_ = enable;
+        auto_reconnect_configured_ = true;
+        reconnect_min_backoff_ms_ = min_backoff_ms;
+        reconnect_max_backoff_ms_ = max_backoff_ms;
+    }
+    virtual bool Connect(const std::string& broker_address, int broker_port, const std::string& client_id, const std::string& username, const std::string& password) = 0;
     virtual void Disconnect() = 0;
-    virtual bool Publish(const std::string topic, const std::string payload, int qos = 0) = 0;
-    virtual bool Subscribe(const std::string topic, int qos = 0) = 0;
-    virtual bool Unsubscribe(const std::string topic) = 0;
+    virtual bool Publish(std::string_view topic, std::string_view payload, int qos = 0) = 0;
+    virtual bool Subscribe(const std::string& topic, int qos = 0) = 0;
+    // 订阅并为该过滤器注册独立的处理函数，支持 + 和 # 通配符
+    bool Subscribe(const std::string& filter, MqttMessageHandler handler, int qos = 0) {
+        {
+            std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+            subscriptions_.Insert(filter, handler);
+        }
+        if (!Subscribe(filter, qos)) {
+            RemoveMessageHandler(filter);
+            return false;
+        }
+        return true;
+    }
+    // 一次往返订阅多个过滤器，逐个填写 granted_qos；全部成功时返回 true
+    virtual bool SubscribeMultiple(std::vector<MqttSubscription>& subscriptions) {
+        bool success = true;
+        for (auto& subscription : subscriptions) {
+            bool subscribed = Subscribe(subscription.filter, subscription.qos);
+            subscription.granted_qos = subscribed ? subscription.qos : MQTT_SUBACK_FAILURE;
+            success = success && subscribed;
+        }
+        return success;
+    }
+    virtual bool Unsubscribe(const std::string& topic) = 0;
     virtual bool IsConnected() = 0;
 
     virtual void OnConnected(std::function<void()> callback) { on_connected_callback_ = callback; }
     virtual void OnDisconnected(std::function<void()> callback) { on_disconnected_callback_ = callback; }
     virtual void OnMessage(std::function<void(const std::string& topic, const std::string& payload)> callback) { on_message_callback_ = callback; }
+    // 以视图形式接收消息，避免复制；视图只在回调期间有效
+    virtual void OnMessageView(std::function<void(std::string_view topic, std::string_view payload)> callback) { on_message_view_callback_ = callback; }
 
 protected:
     int keep_alive_seconds_ = 60;
+    bool clean_session_ = true;
+    bool auto_reconnect_ = false;
+    // 没有调用过 SetAutoReconnect 时各实现保留自己的默认重连行为
+    bool auto_reconnect_configured_ = false;
+    int reconnect_min_backoff_ms_ = MQTT_RECONNECT_MIN_BACKOFF_MS;
+    int reconnect_max_backoff_ms_ = MQTT_RECONNECT_MAX_BACKOFF_MS;
+    std::mutex subscriptions_mutex_;
+    MqttTopicTrie subscriptions_;
+    // 已订阅的主题及 QoS，重连后重新订阅
+    std::map<std::string, int> subscribed_topics_;
     std::function<void(const std::string& topic, const std::string& payload)> on_message_callback_;
+    std::function<void(std::string_view topic, std::string_view payload)> on_message_view_callback_;
     std::function<void()> on_connected_callback_;
     std::function<void()> on_disconnected_callback_;
+
+    void RemoveMessageHandler(const std::string& filter) {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        subscriptions_.Remove(filter);
+    }
+
+    void RememberSubscription(const std::string& filter, int qos) {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        subscribed_topics_[filter] = qos;
+    }
+
+    void ForgetSubscription(const std::string& filter) {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        subscriptions_.Remove(filter);
+        subscribed_topics_.erase(filter);
+    }
+
+    std::vector<MqttSubscription> GetSubscribedTopics() {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        std::vector<MqttSubscription> subscriptions;
+        subscriptions.reserve(subscribed_topics_.size());
+        for (auto& item : subscribed_topics_) {
+            subscriptions.push_back({item.first, item.second});
+        }
+        return subscriptions;
+    }
+
+    // 视图版本只在有 std::string 形式的接收者时才复制
+    void DispatchMessage(std::string_view topic, std::string_view payload) {
+        if (on_message_view_callback_) {
+            on_message_view_callback_(topic, payload);
+        }
+        bool has_handlers;
+        {
+            std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+            has_handlers = !subscriptions_.empty();
+        }
+        if (has_handlers || on_message_callback_) {
+            DispatchStringMessage(std::string(topic), std::string(payload));
+        }
+    }
+
+    void DispatchMessage(const std::string& topic, const std::string& payload) {
+        if (on_message_view_callback_) {
+            on_message_view_callback_(topic, payload);
+        }
+        DispatchStringMessage(topic, payload);
+    }
+
+private:
+    // 先交给匹配的过滤器处理函数，再交给 OnMessage 回调
+    void DispatchStringMessage(const std::string& topic, const std::string& payload) {
+        std::vector<MqttMessageHandler> handlers;
+        {
+            std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+            if (!subscriptions_.empty()) {
+                subscriptions_.Match(topic, handlers);
+            }
+        }
+        for (auto& handler : handlers) {
+            handler(topic, payload);
+        }
+        if (on_message_callback_) {
+            on_message_callback_(topic, payload);
+        }
+    }
 };
 
 #endif // MQTT_INTERFACE_H
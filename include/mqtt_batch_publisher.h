@@ -0,0 +1,83 @@
+#ifndef MQTT_BATCH_PUBLISHER_H
+#define MQTT_BATCH_PUBLISHER_H
+
+#include "mqtt.h"
+
+#include <string>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <cstdint>
+
+#define MQTT_BATCH_DEFAULT_MAX_BYTES 1024
+#define MQTT_BATCH_DEFAULT_MAX_DELAY_MS 1000
+// 发布失败后每个主题最多保留的待发批次，超过时丢弃最早的批次
+#define MQTT_BATCH_MAX_PENDING 8
+
+struct MqttBatchStats {
+    uint32_t records;
+    uint32_t batches;
+    uint32_t payload_bytes;
+    uint32_t framed_bytes;
+    // 与逐条发布相比省下的 MQTT PUBLISH 头部及主题字节数
+    int32_t bytes_saved;
+    float records_per_second;
+    // 待发队列满时丢弃的批次数
+    uint32_t dropped_batches;
+    // 发布失败的次数，失败的批次留在待发队列中重试
+    uint32_t publish_failures;
+};
+
+// 遥测批量发布：按主题累积小记录，达到大小阈值、超过时间期限或显式 Flush 时合并为一条消息发布
+// 消息格式为若干条记录首尾相接，每条记录前带 varint（LEB128）长度
+class MqttBatchPublisher {
+public:
+    MqttBatchPublisher(Mqtt& mqtt, size_t max_batch_bytes = MQTT_BATCH_DEFAULT_MAX_BYTES, int max_delay_ms = MQTT_BATCH_DEFAULT_MAX_DELAY_MS, int qos = 0);
+    ~MqttBatchPublisher();
+
+    // 记录加入批次后返回 true。批次达到 max_batch_bytes 时立即发布，发布失败不影响返回值，
+    // 批次保留到下次 Add/Flush 或定时器重试，调用者不应重新添加；失败次数见 publish_failures
+    bool Add(const std::string& topic, const std::string& record);
+    // 发布失败返回 false，未发出的批次保留重试
+    bool Flush(const std::string& topic);
+    bool Flush();
+    MqttBatchStats GetStats();
+
+    // 拆分批量消息，返回 false 表示格式错误
+    static bool Unpack(const std::string& payload, std::function<void(const char* data, size_t length)> callback);
+
+private:
+    struct Batch {
+        std::string payload;
+        uint32_t records = 0;
+        uint32_t record_bytes = 0;
+        int64_t deadline_us = 0;
+    };
+
+    Mqtt& mqtt_;
+    size_t max_batch_bytes_;
+    int max_delay_ms_;
+    int qos_;
+    bool stopping_ = false;
+    int64_t start_time_us_;
+    MqttBatchStats stats_ = {};
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::map<std::string, Batch> batches_;
+    // 已封口等待发布的批次，按主题先进先出
+    std::map<std::string, std::deque<Batch>> ready_;
+    // 取批次和发布在同一把锁内完成，同一主题的批次不会乱序
+    std::mutex publish_mutex_;
+    std::thread flush_thread_;
+
+    void SealLocked(const std::string& topic, Batch&& batch);
+    bool PublishReady(const std::string& topic);
+    bool Publish(const std::string& topic, const Batch& batch);
+    void FlushTask();
+};
+
+#endif // MQTT_BATCH_PUBLISHER_H
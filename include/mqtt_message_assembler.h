@@ -0,0 +1,34 @@
+#ifndef MQTT_MESSAGE_ASSEMBLER_H
+#define MQTT_MESSAGE_ASSEMBLER_H
+
+#include <string>
+#include <map>
+#include <cstdint>
+
+#define MQTT_DEFAULT_MAX_MESSAGE_SIZE (64 * 1024)
+#define MQTT_MAX_PARTIAL_MESSAGES 4
+
+// 分段到达的 PUBLISH 消息重组，按报文 ID / 主题区分，互不干扰
+class MqttMessageAssembler {
+public:
+    struct PartialMessage {
+        std::string topic;
+        std::string payload;
+        size_t total_length;
+        uint32_t sequence;
+    };
+
+    void SetMaxMessageSize(size_t max_message_size) { max_message_size_ = max_message_size; }
+
+    // 获取（或创建并按总长度预分配）重组缓冲区，超过上限时返回 nullptr
+    PartialMessage* Get(const std::string& key, const std::string& topic, size_t total_length);
+    void Remove(const std::string& key) { partial_messages_.erase(key); }
+    void Clear() { partial_messages_.clear(); }
+
+private:
+    std::map<std::string, PartialMessage> partial_messages_;
+    size_t max_message_size_ = MQTT_DEFAULT_MAX_MESSAGE_SIZE;
+    uint32_t next_sequence_ = 0;
+};
+
+#endif // MQTT_MESSAGE_ASSEMBLER_H
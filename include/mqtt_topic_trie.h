@@ -0,0 +1,38 @@
+#ifndef MQTT_TOPIC_TRIE_H
+#define MQTT_TOPIC_TRIE_H
+
+#include <string>
+#include <map>
+#include <memory>
+#include <vector>
+#include <functional>
+
+typedef std::function<void(const std::string& topic, const std::string& payload)> MqttMessageHandler;
+
+// 按主题层级组织的订阅过滤器树，支持 + 和 # 通配符
+// 匹配耗时只与主题层数相关，与订阅数量无关
+class MqttTopicTrie {
+public:
+    // 同一过滤器重复插入时替换原有处理函数
+    void Insert(const std::string& filter, MqttMessageHandler handler);
+    bool Remove(const std::string& filter);
+    void Match(const std::string& topic, std::vector<MqttMessageHandler>& handlers) const;
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+private:
+    struct Node {
+        std::map<std::string, std::unique_ptr<Node>, std::less<>> children;
+        MqttMessageHandler handler;
+        // 以 # 结尾的过滤器挂在其父层级上
+        MqttMessageHandler multi_level_handler;
+    };
+
+    Node root_;
+    size_t size_ = 0;
+
+    static void MatchLevel(const Node& node, const std::string& topic, size_t start, bool first_level, std::vector<MqttMessageHandler>& handlers);
+    static bool RemoveLevel(Node& node, const std::string& filter, size_t start, bool& removed);
+};
+
+#endif // MQTT_TOPIC_TRIE_H
@@ -0,0 +1,27 @@
+#ifndef NETWORK_BACKEND_H
+#define NETWORK_BACKEND_H
+
+#include "transport.h"
+#include "http.h"
+#include "mqtt.h"
+#include "udp.h"
+#include "udp_endpoint.h"
+
+// 网络后端：按链路创建协议对象，应用可以在运行时切换 Wi-Fi 和 Cat.1
+// 返回的对象由调用者负责释放；后端资源（如模组连接 ID）用完或不支持该对象时返回 nullptr
+class NetworkBackend {
+public:
+    virtual ~NetworkBackend() = default;
+
+    virtual const char* name() const = 0;
+    // 链路已经可以收发数据
+    virtual bool IsReady() = 0;
+
+    virtual Transport* CreateTlsTransport() = 0;
+    virtual Http* CreateHttp() = 0;
+    virtual Mqtt* CreateMqtt() = 0;
+    virtual Udp* CreateUdp() = 0;
+    virtual UdpEndpoint* CreateUdpEndpoint() = 0;
+};
+
+#endif // NETWORK_BACKEND_H
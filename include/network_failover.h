@@ -0,0 +1,91 @@
+#ifndef NETWORK_FAILOVER_H
+#define NETWORK_FAILOVER_H
+
+#include "network_backend.h"
+#include "udp_probe.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <string>
+
+#define NETWORK_FAILOVER_TASK_EXIT BIT0
+
+#define NETWORK_FAILOVER_CHECK_INTERVAL_MS 1000
+#define NETWORK_FAILOVER_DEFAULT_MAX_RTT_MS 800
+#define NETWORK_FAILOVER_DEFAULT_MAX_LOSS 0.2f
+// 首选链路不健康持续多久后切到备用链路
+#define NETWORK_FAILOVER_DEFAULT_FAIL_HOLD_MS 3000
+// 首选链路恢复后需要持续健康多久才切回，避免来回切换
+#define NETWORK_FAILOVER_DEFAULT_RECOVER_HOLD_MS 30000
+#define NETWORK_FAILOVER_PRIMARY_PROBE_INTERVAL_MS 500
+// 备用链路低频探测，保持蜂窝连接和 NAT 映射处于活跃状态
+#define NETWORK_FAILOVER_BACKUP_PROBE_INTERVAL_MS 5000
+
+struct LinkHealth {
+    bool ready;
+    bool healthy;
+    uint32_t rtt_ms;
+    float loss_rate;
+};
+
+// 在首选链路（通常是 Wi-Fi，节省蜂窝流量）和备用链路（Cat.1）之间选择新会话使用的后端
+// 已建立的会话不会被迁移，由应用在 OnSwitch 中决定是否重连
+class NetworkFailover {
+public:
+    NetworkFailover(NetworkBackend& primary, NetworkBackend& backup);
+    ~NetworkFailover();
+
+    // 通过 UDP 回显服务测量每条链路的 RTT 和丢包，不设置时只根据链路是否就绪判断
+    void SetProbeTarget(const std::string& echo_host, int echo_port);
+    void SetThresholds(uint32_t max_rtt_ms, float max_loss, int fail_hold_ms = NETWORK_FAILOVER_DEFAULT_FAIL_HOLD_MS,
+        int recover_hold_ms = NETWORK_FAILOVER_DEFAULT_RECOVER_HOLD_MS);
+    void OnSwitch(std::function<void(NetworkBackend& backend)> callback);
+
+    void Start();
+    void Stop();
+
+    // 新会话应使用的后端
+    NetworkBackend& Current();
+    LinkHealth GetPrimaryHealth();
+    LinkHealth GetBackupHealth();
+
+private:
+    struct Link {
+        NetworkBackend& backend;
+        int probe_interval_ms;
+        std::unique_ptr<Udp> udp;
+        std::unique_ptr<UdpProbe> probe;
+        LinkHealth health = {};
+        // 当前健康状态开始的时间
+        int64_t state_since_us = 0;
+
+        Link(NetworkBackend& backend, int probe_interval_ms) : backend(backend), probe_interval_ms(probe_interval_ms) {}
+    };
+
+    Link primary_;
+    Link backup_;
+    bool using_primary_ = true;
+    std::mutex mutex_;
+    EventGroupHandle_t event_group_handle_;
+    TaskHandle_t monitor_task_handle_ = nullptr;
+    std::atomic<bool> stopping_{false};
+    std::function<void(NetworkBackend& backend)> on_switch_callback_;
+
+    std::string echo_host_;
+    int echo_port_ = 0;
+    uint32_t max_rtt_ms_ = NETWORK_FAILOVER_DEFAULT_MAX_RTT_MS;
+    float max_loss_ = NETWORK_FAILOVER_DEFAULT_MAX_LOSS;
+    int64_t fail_hold_us_ = NETWORK_FAILOVER_DEFAULT_FAIL_HOLD_MS * 1000LL;
+    int64_t recover_hold_us_ = NETWORK_FAILOVER_DEFAULT_RECOVER_HOLD_MS * 1000LL;
+
+    void MonitorTask();
+    void UpdateLink(Link& link, int64_t now);
+    void StopProbe(Link& link);
+};
+
+#endif // NETWORK_FAILOVER_H
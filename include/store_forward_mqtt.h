@@ -0,0 +1,89 @@
+#ifndef STORE_FORWARD_MQTT_H
+#define STORE_FORWARD_MQTT_H
+
+#include "mqtt.h"
+
+#include <string>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+
+#define STORE_FORWARD_DEFAULT_CAPACITY 64
+#define STORE_FORWARD_DEFAULT_DRAIN_INTERVAL_MS 100
+#define STORE_FORWARD_DEFAULT_SPILL_MAX_BYTES (64 * 1024)
+// 系统时间早于 2024-01-01 说明还没有完成 SNTP 同步，此时不按墙上时间判断过期
+#define STORE_FORWARD_MIN_VALID_TIME 1704067200
+
+// 离线发布队列：断线期间的消息先存入内存环形队列（可选溢写到文件），
+// 重新连接后按设定速率自动补发
+class StoreForwardMqtt : public Mqtt {
+public:
+    // 接管 mqtt 的所有权，析构时一并删除
+    StoreForwardMqtt(Mqtt* mqtt, size_t capacity = STORE_FORWARD_DEFAULT_CAPACITY);
+    ~StoreForwardMqtt();
+
+    // 内存队列满后溢写到文件（如 SPIFFS/LittleFS 上的路径），传空字符串关闭
+    void SetSpillFile(const std::string& path, size_t max_bytes = STORE_FORWARD_DEFAULT_SPILL_MAX_BYTES);
+    void SetDrainInterval(int interval_ms);
+    // 默认消息有效期，0 表示永不过期。内存中的消息按开机时间计时；
+    // 溢写到文件的消息跨重启按系统时间判断，入队时时间未同步的消息重启后不再过期
+    void SetDefaultExpiry(int expiry_seconds);
+
+    bool Connect(const std::string& broker_address, int broker_port, const std::string& client_id, const std::string& username, const std::string& password) override;
+    void Disconnect() override;
+    // 直接发送或放入队列后返回 true，溢写文件已满或写入失败、消息被丢弃时返回 false
+    bool Publish(std::string_view topic, std::string_view payload, int qos = 0) override;
+    bool Publish(std::string_view topic, std::string_view payload, int qos, int expiry_seconds);
+    bool Subscribe(const std::string& topic, int qos = 0) override;
+    using Mqtt::Subscribe;
+    bool SubscribeMultiple(std::vector<MqttSubscription>& subscriptions) override;
+    bool Unsubscribe(const std::string& topic) override;
+    bool IsConnected() override;
+
+    size_t GetQueuedCount();
+    size_t GetDroppedCount();
+
+private:
+    struct QueuedMessage {
+        std::string topic;
+        std::string payload;
+        int qos;
+        // 墙上时间的过期时刻，写入溢写文件；0 表示不过期或入队时时间未同步
+        uint32_t expire_at;
+        // 开机时间的过期时刻，只在内存中有效，0 表示不过期
+        int64_t deadline_us = 0;
+        // 从溢写文件读出的消息记录结束位置，0 表示来自内存
+        uint32_t spill_end = 0;
+    };
+
+    Mqtt* mqtt_;
+    size_t capacity_;
+    int drain_interval_ms_ = STORE_FORWARD_DEFAULT_DRAIN_INTERVAL_MS;
+    int default_expiry_seconds_ = 0;
+    bool online_ = false;
+    bool stopping_ = false;
+    size_t dropped_count_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<QueuedMessage> queue_;
+    std::thread drain_thread_;
+
+    std::string spill_path_;
+    size_t spill_max_bytes_ = 0;
+    size_t spill_size_ = 0;
+    size_t spill_read_offset_ = 0;
+    std::string spill_offset_path_;
+
+    bool Enqueue(QueuedMessage&& message);
+    bool SpillAppend(const QueuedMessage& message);
+    void SpillLoad();
+    void SpillCommit(uint32_t offset);
+    void OnMessageDone(const QueuedMessage& message);
+    bool IsExpired(const QueuedMessage& message) const;
+    void DrainTask();
+};
+
+#endif // STORE_FORWARD_MQTT_H
@@ -3,11 +3,23 @@
 
 #include "transport.h"
 
+struct sockaddr;
+
+#define TCP_DEFAULT_CONNECT_TIMEOUT_MS 10000
+
 class TcpTransport : public Transport {
 public:
     TcpTransport();
     ~TcpTransport();
 
+    // 以下选项在下一次 Connect 时生效
+    void SetConnectTimeout(int timeout_ms);
+    // 默认开启，避免 Nagle 算法延迟小的 WebSocket 帧
+    void SetNoDelay(bool enable);
+    void SetKeepAlive(bool enable, int idle_seconds = 60, int interval_seconds = 10, int count = 3);
+    // 0 表示使用协议栈默认值
+    void SetBufferSizes(int send_buffer_size, int receive_buffer_size);
+
     bool Connect(const char* host, int port) override;
     void Disconnect() override;
     int Send(const char* data, size_t length) override;
@@ -15,6 +27,17 @@ public:
 
 private:
     int fd_;
+    int connect_timeout_ms_ = TCP_DEFAULT_CONNECT_TIMEOUT_MS;
+    bool no_delay_ = true;
+    bool keep_alive_ = false;
+    int keep_alive_idle_ = 60;
+    int keep_alive_interval_ = 10;
+    int keep_alive_count_ = 3;
+    int send_buffer_size_ = 0;
+    int receive_buffer_size_ = 0;
+
+    void ApplySocketOptions();
+    bool ConnectWithTimeout(const struct sockaddr* addr, size_t addr_len);
 };
 
-#endif // _TCP_TRANSPORT_H_
\ No newline at end of file
+#endif // _TCP_TRANSPORT_H_
@@ -3,6 +3,11 @@
 
 #include "transport.h"
 #include <esp_tls.h>
+#include <cstdint>
+
+#define TLS_DEFAULT_SEND_TIMEOUT_MS 10000
+// 接收任务至少每隔这么久返回一次，以便检查连接状态和退出标志
+#define TLS_DEFAULT_RECEIVE_TIMEOUT_MS 1000
 
 class TlsTransport : public Transport {
 public:
@@ -14,8 +19,25 @@ public:
     int Send(const char* data, size_t length) override;
     int Receive(char* buffer, size_t bufferSize) override;
 
+    // Send 等待套接字可写的最长时间，超时视为连接失效
+    // Receive 没有数据时等待的最长时间，超时返回 TRANSPORT_RECEIVE_TIMEOUT；-1 表示一直等待
+    void SetTimeouts(int send_timeout_ms, int receive_timeout_ms);
+
+    // 最近一次 Connect 的握手耗时，以及是否携带了缓存的会话（需开启 CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS）
+    int64_t last_handshake_us() const { return last_handshake_us_; }
+    bool session_offered() const { return session_offered_; }
+    // 丢弃所有缓存的会话，之后的连接重新完整握手
+    static void ClearSessionCache();
+
 private:
     esp_tls_t* tls_client_;
+    int64_t last_handshake_us_ = 0;
+    bool session_offered_ = false;
+    int send_timeout_ms_ = TLS_DEFAULT_SEND_TIMEOUT_MS;
+    int receive_timeout_ms_ = TLS_DEFAULT_RECEIVE_TIMEOUT_MS;
+
+    // 返回 1 表示就绪，0 表示超时，-1 表示出错
+    int WaitSocket(short events, int timeout_ms);
 };
 
 #endif // _TLS_TRANSPORT_H_
\ No newline at end of file
@@ -3,6 +3,9 @@
 
 #include <cstddef>
 
+// Receive 在超时时间内没有收到数据，连接仍然有效；0 表示对端已关闭
+#define TRANSPORT_RECEIVE_TIMEOUT (-2)
+
 class Transport {
 public:
     virtual ~Transport() = default;
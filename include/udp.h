@@ -4,6 +4,11 @@
 
 #include <string>
 #include <functional>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+#include "datagram_pool.h"
 
 class Udp {
 public:
@@ -15,11 +20,26 @@ public:
     virtual void OnMessage(std::function<void(const std::string& data)> callback) {
         message_callback_ = callback;
     }
+    // 以池化缓冲区接收数据报，句柄析构或 Release() 时缓冲区归还到池中
+    // 池耗尽或数据报超过缓冲区大小时，设置了 OnMessage 则改由 OnMessage 交付，否则丢弃并计入 dropped_count()
+    virtual void OnMessageBuffer(std::function<void(DatagramBuffer buffer)> callback) {
+        if (!buffer_pool_) {
+            buffer_pool_ = DatagramPool::Create();
+        }
+        buffer_callback_ = callback;
+    }
+    // 传 nullptr 恢复默认池，接收路径上总有可用的池
+    void SetBufferPool(std::shared_ptr<DatagramPool> pool) { buffer_pool_ = pool ? pool : DatagramPool::Create(); }
     bool connected() const { return connected_; }
+    // 接收路径上因没有可用缓冲区而丢弃的数据报数量
+    uint32_t dropped_count() const { return dropped_count_; }
 
 protected:
     std::function<void(const std::string& data)> message_callback_;
+    std::function<void(DatagramBuffer buffer)> buffer_callback_;
+    std::shared_ptr<DatagramPool> buffer_pool_;
     bool connected_ = false;
+    std::atomic<uint32_t> dropped_count_{0};
 };
 
 #endif // UDP_H
@@ -0,0 +1,27 @@
+#ifndef UDP_ENDPOINT_H
+#define UDP_ENDPOINT_H
+
+#include <string>
+#include <functional>
+
+// 未连接的 UDP 套接字：每个数据报单独指定目的地址，接收时报告来源地址
+// 一个本地端口即可与多个对端通信（多个媒体中继、STUN 探测等）
+class UdpEndpoint {
+public:
+    virtual ~UdpEndpoint() = default;
+    // local_port 为 0 时由协议栈分配
+    virtual bool Bind(int local_port = 0) = 0;
+    virtual void Close() = 0;
+    virtual int SendTo(const std::string& host, int port, const std::string& data) = 0;
+
+    virtual void OnMessage(std::function<void(const std::string& host, int port, const std::string& data)> callback) {
+        message_callback_ = callback;
+    }
+    bool bound() const { return bound_; }
+
+protected:
+    std::function<void(const std::string& host, int port, const std::string& data)> message_callback_;
+    bool bound_ = false;
+};
+
+#endif // UDP_ENDPOINT_H
@@ -0,0 +1,121 @@
+#ifndef UDP_PROBE_H
+#define UDP_PROBE_H
+
+#include "udp.h"
+#include "udp_endpoint.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <string>
+#include <cstdint>
+
+#define UDP_PROBE_TASK_EXIT BIT0
+#define UDP_ECHO_TASK_EXIT BIT0
+// 回显队列满时丢弃新收到的数据报
+#define UDP_ECHO_QUEUE_DEPTH 16
+
+// 统计窗口内的探测包数量
+#define UDP_PROBE_WINDOW 64
+#define UDP_PROBE_DEFAULT_INTERVAL_MS 200
+// 超过该时间未收到回显的探测包视为丢失
+#define UDP_PROBE_DEFAULT_TIMEOUT_MS 2000
+#define UDP_PROBE_MAGIC 0x50524231 // "PRB1"
+// magic(4) sequence(4) timestamp_us(8)，大端
+#define UDP_PROBE_HEADER_SIZE 16
+
+struct UdpProbeStats {
+    uint32_t sent;
+    uint32_t received;
+    // 以下基于最近 UDP_PROBE_WINDOW 个已超时或已回显的探测包
+    float loss_rate;
+    uint32_t rtt_min_us;
+    uint32_t rtt_avg_us;
+    uint32_t rtt_p50_us;
+    uint32_t rtt_p95_us;
+    uint32_t rtt_max_us;
+    // RFC 3550 方式平滑的 RTT 变化量
+    uint32_t jitter_us;
+};
+
+// 向回显对端周期发送带序号和时间戳的探测包，持续统计 RTT 分布、丢包率和抖动
+// 探测会接管 udp 的 OnMessage 回调，应使用单独的连接。回调在第一次 Start 时设置后不再替换，
+// Stop 之后收到的回显直接忽略；析构时断开 udp 再清除回调，保证回调不会在析构后执行
+class UdpProbe {
+public:
+    UdpProbe(Udp& udp);
+    ~UdpProbe();
+
+    void Start(int interval_ms = UDP_PROBE_DEFAULT_INTERVAL_MS, size_t packet_size = UDP_PROBE_HEADER_SIZE, int timeout_ms = UDP_PROBE_DEFAULT_TIMEOUT_MS);
+    void Stop();
+    UdpProbeStats GetStats();
+
+private:
+    struct Slot {
+        uint32_t sequence;
+        int64_t send_time_us;
+        int64_t rtt_us;  // -1 表示尚未收到回显
+    };
+
+    Udp& udp_;
+    EventGroupHandle_t event_group_handle_;
+    TaskHandle_t probe_task_handle_ = nullptr;
+    std::atomic<bool> stopping_{false};
+    bool callback_installed_ = false;
+    int interval_ms_ = UDP_PROBE_DEFAULT_INTERVAL_MS;
+    int64_t timeout_us_ = UDP_PROBE_DEFAULT_TIMEOUT_MS * 1000LL;
+    size_t packet_size_ = UDP_PROBE_HEADER_SIZE;
+
+    std::mutex mutex_;
+    // 由 mutex_ 保护，Stop 返回后 HandleEcho 不再修改统计
+    bool active_ = false;
+    Slot slots_[UDP_PROBE_WINDOW];
+    uint32_t next_sequence_ = 0;
+    uint32_t sent_ = 0;
+    uint32_t received_ = 0;
+    int64_t last_rtt_us_ = -1;
+    int64_t jitter_us_x16_ = 0;
+
+    void ProbeTask();
+    void HandleEcho(const std::string& data);
+};
+
+// 简单的 UDP 回显服务，原样发回收到的数据报，用作 UdpProbe 的对端
+// 接收回调只把数据报放入队列，由回显任务调用 SendTo：
+// Ml307UdpEndpoint 在 URC 回调中交付数据报，在回调里发送 AT 命令会死锁
+// Stop 先在锁内标记停止、关闭端点（接收任务退出后）再清除回调，之后不会再有数据报入队
+class UdpEchoServer {
+public:
+    UdpEchoServer(UdpEndpoint& endpoint);
+    ~UdpEchoServer();
+    bool Start(int port);
+    void Stop();
+    uint32_t echoed() const { return echoed_; }
+    uint32_t dropped() const { return dropped_; }
+
+private:
+    struct Echo {
+        std::string host;
+        int port;
+        std::string data;
+    };
+
+    UdpEndpoint& endpoint_;
+    EventGroupHandle_t event_group_handle_;
+    TaskHandle_t echo_task_handle_ = nullptr;
+    std::atomic<uint32_t> echoed_{0};
+    std::atomic<uint32_t> dropped_{0};
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Echo> queue_;
+    bool stopping_ = false;
+
+    void EchoTask();
+};
+
+#endif // UDP_PROBE_H
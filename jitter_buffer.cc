@@ -0,0 +1,154 @@
+#include "jitter_buffer.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+
+static const char *TAG = "JitterBuffer";
+
+JitterBuffer::JitterBuffer(int frame_duration_ms, int min_delay_ms, int max_delay_ms, size_t capacity)
+    : frame_duration_us_(frame_duration_ms * 1000LL), min_delay_us_(min_delay_ms * 1000LL),
+      max_delay_us_(max_delay_ms * 1000LL), capacity_(capacity > 0 ? capacity : 1) {
+}
+
+void JitterBuffer::Attach(Udp& udp, SequenceExtractor extractor) {
+    udp.OnMessageBuffer([this, extractor](DatagramBuffer buffer) {
+        uint16_t sequence;
+        if (extractor(buffer.data(), buffer.size(), sequence)) {
+            Push(sequence, std::move(buffer));
+        }
+    });
+}
+
+uint32_t JitterBuffer::ExtendSequence(uint16_t sequence) {
+    // 16 位序号回绕后扩展为 32 位，以最高序号为参考
+    if (!has_sequence_) {
+        has_sequence_ = true;
+        highest_sequence_ = sequence + 0x10000;
+        base_sequence_ = highest_sequence_;
+        next_sequence_ = highest_sequence_;
+        return highest_sequence_;
+    }
+    uint32_t extended = highest_sequence_ + (int16_t)(sequence - (uint16_t)highest_sequence_);
+    if ((int32_t)(extended - highest_sequence_) > 0) {
+        highest_sequence_ = extended;
+    }
+    if ((int32_t)(extended - base_sequence_) < 0) {
+        base_sequence_ = extended;
+    }
+    return extended;
+}
+
+int64_t JitterBuffer::TargetDelayUs() const {
+    // 目标延迟 = 一帧 + 3 倍抖动
+    int64_t target = frame_duration_us_ + 3 * (jitter_us_x16_ >> 4);
+    return std::clamp(target, min_delay_us_, max_delay_us_);
+}
+
+void JitterBuffer::Push(uint16_t sequence, DatagramBuffer buffer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now = esp_timer_get_time();
+    uint32_t extended = ExtendSequence(sequence);
+    stats_.received++;
+
+    // 到达时间与发送时间（按序号推算）之差的变化即为抖动
+    int64_t transit = now - (int64_t)extended * frame_duration_us_;
+    if (has_transit_) {
+        int64_t d = std::abs(transit - last_transit_us_);
+        jitter_us_x16_ += d - (jitter_us_x16_ >> 4);
+    }
+    has_transit_ = true;
+    last_transit_us_ = transit;
+
+    // 已经播放过的位置之前的包到得太晚，直接丢弃（重新缓冲时同样适用）
+    if ((playing_ || stats_.played > 0) && (int32_t)(extended - next_sequence_) < 0) {
+        stats_.late++;
+        return;
+    }
+    if (packets_.find(extended) != packets_.end()) {
+        stats_.duplicate++;
+        return;
+    }
+    if (packets_.empty() && !playing_) {
+        buffering_start_us_ = now;
+    }
+    packets_.emplace(extended, std::move(buffer));
+
+    if (packets_.size() > capacity_) {
+        // 容量满时丢弃最早的包，同时前移播放位置
+        auto oldest = packets_.begin();
+        if ((int32_t)(oldest->first + 1 - next_sequence_) > 0) {
+            next_sequence_ = oldest->first + 1;
+        }
+        packets_.erase(oldest);
+        stats_.discarded++;
+    }
+}
+
+bool JitterBuffer::Pop(DatagramBuffer& buffer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now = esp_timer_get_time();
+    int64_t target_delay = TargetDelayUs();
+
+    if (!playing_) {
+        // 缓冲到目标延迟后再开始播放
+        if (packets_.empty() || now - buffering_start_us_ < target_delay) {
+            return false;
+        }
+        playing_ = true;
+        next_sequence_ = packets_.begin()->first;
+    }
+
+    if (packets_.empty()) {
+        ESP_LOGD(TAG, "Underrun, rebuffering");
+        playing_ = false;
+        stats_.underrun++;
+        return false;
+    }
+
+    // 积压明显超过目标延迟时跳过最早的一帧以降低延迟
+    // 丢包数由序号范围推算，这里跳过缺失的帧不再另外计数
+    int64_t buffered = (int64_t)(packets_.rbegin()->first - next_sequence_ + 1) * frame_duration_us_;
+    if (buffered > target_delay + 2 * frame_duration_us_) {
+        auto it = packets_.find(next_sequence_);
+        if (it != packets_.end()) {
+            packets_.erase(it);
+            stats_.discarded++;
+        }
+        next_sequence_++;
+    }
+
+    auto it = packets_.find(next_sequence_);
+    next_sequence_++;
+    if (it == packets_.end()) {
+        stats_.concealed++;
+        return false;
+    }
+    buffer = std::move(it->second);
+    packets_.erase(it);
+    stats_.played++;
+    return true;
+}
+
+void JitterBuffer::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    packets_.clear();
+    has_sequence_ = false;
+    playing_ = false;
+    has_transit_ = false;
+    jitter_us_x16_ = 0;
+    stats_ = {};
+}
+
+JitterBufferStats JitterBuffer::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    JitterBufferStats stats = stats_;
+    if (has_sequence_) {
+        int64_t expected = (int64_t)(highest_sequence_ - base_sequence_) + 1;
+        int64_t received = (int64_t)stats_.received - stats_.duplicate;
+        stats.lost = expected > received ? expected - received : 0;
+    }
+    stats.jitter_ms = (jitter_us_x16_ >> 4) / 1000;
+    stats.target_delay_ms = TargetDelayUs() / 1000;
+    stats.buffered_ms = packets_.empty() ? 0 : (packets_.rbegin()->first - (playing_ ? next_sequence_ : packets_.begin()->first) + 1) * frame_duration_us_ / 1000;
+    return stats;
+}
@@ -179,6 +179,53 @@ bool Ml307AtModem::Command(const std::string command, int timeout_ms) {
     return false;
 }
 
+bool Ml307AtModem::CommandWithData(const std::string& command, const char* data, size_t length, int timeout_ms) {
+    std::lock_guard<std::mutex> lock(command_mutex_);
+    if (debug_) {
+        ESP_LOGI(TAG, ">> %.64s (+%zu bytes)", command.c_str(), length);
+    }
+    response_.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        last_command_ = command + "\r\n";
+        data_prompt_pending_ = true;
+        int ret = uart_write_bytes(uart_num_, last_command_.c_str(), last_command_.length());
+        if (ret < 0) {
+            ESP_LOGE(TAG, "uart_write_bytes failed: %d", ret);
+            data_prompt_pending_ = false;
+            return false;
+        }
+    }
+
+    // 等待 ">" 提示符
+    auto bits = xEventGroupWaitBits(event_group_handle_, AT_EVENT_COMMAND_DONE | AT_EVENT_COMMAND_ERROR, pdTRUE, pdFALSE, pdMS_TO_TICKS(timeout_ms));
+    data_prompt_pending_ = false;
+    if (!(bits & AT_EVENT_COMMAND_DONE)) {
+        ESP_LOGE(TAG, "no prompt for command: %s", command.c_str());
+        return false;
+    }
+
+    // 原始数据按块写入，避免一次占满 UART 发送缓冲
+    size_t offset = 0;
+    while (offset < length) {
+        size_t chunk_size = std::min(length - offset, (size_t)RAW_DATA_CHUNK_SIZE);
+        int ret = uart_write_bytes(uart_num_, data + offset, chunk_size);
+        if (ret < 0) {
+            ESP_LOGE(TAG, "uart_write_bytes failed: %d", ret);
+            return false;
+        }
+        offset += ret;
+    }
+
+    bits = xEventGroupWaitBits(event_group_handle_, AT_EVENT_COMMAND_DONE | AT_EVENT_COMMAND_ERROR, pdTRUE, pdFALSE, pdMS_TO_TICKS(timeout_ms));
+    if (bits & AT_EVENT_COMMAND_DONE) {
+        return true;
+    } else if (bits & AT_EVENT_COMMAND_ERROR) {
+        ESP_LOGE(TAG, "command error: %s", command.c_str());
+    }
+    return false;
+}
+
 void Ml307AtModem::EventTask() {
     uart_event_t event;
     while (true) {
@@ -224,6 +271,15 @@ void Ml307AtModem::ReceiveTask() {
 }
 
 bool Ml307AtModem::ParseResponse() {
+    // 数据提示符 "> " 后面没有换行，需要在按行解析之前处理
+    // 其它时候行首的 '>' 可能是 URC 或数据的一部分，按普通行处理
+    if (data_prompt_pending_ && rx_buffer_.size() >= 1 && rx_buffer_[0] == '>') {
+        data_prompt_pending_ = false;
+        rx_buffer_.erase(0, (rx_buffer_.size() >= 2 && rx_buffer_[1] == ' ') ? 2 : 1);
+        xEventGroupSetBits(event_group_handle_, AT_EVENT_COMMAND_DONE);
+        return true;
+    }
+
     auto end_pos = rx_buffer_.find("\r\n");
     if (end_pos == std::string::npos) {
         return false;
@@ -283,10 +339,6 @@ bool Ml307AtModem::ParseResponse() {
         rx_buffer_.erase(0, 4);
         xEventGroupSetBits(event_group_handle_, AT_EVENT_COMMAND_DONE);
         return true;
-    } else if (rx_buffer_.size() >= 1 && rx_buffer_[0] == '>') {
-        rx_buffer_.erase(0, 1);
-        xEventGroupSetBits(event_group_handle_, AT_EVENT_COMMAND_DONE);
-        return true;
     } else if (rx_buffer_.size() >= 7 && rx_buffer_[0] == 'E' && rx_buffer_[1] == 'R' && rx_buffer_[2] == 'R' && rx_buffer_[3] == 'O' && rx_buffer_[4] == 'R' && rx_buffer_[5] == '\r' && rx_buffer_[6] == '\n') {
         rx_buffer_.erase(0, 7);
         xEventGroupSetBits(event_group_handle_, AT_EVENT_COMMAND_ERROR);
@@ -370,6 +422,14 @@ void Ml307AtModem::DecodeHexAppend(std::string& dest, const char* data, size_t l
     }
 }
 
+size_t Ml307AtModem::DecodeHexTo(char* dest, size_t dest_size, const char* data, size_t length) {
+    size_t count = std::min(length / 2, dest_size);
+    for (size_t i = 0; i < count; i++) {
+        dest[i] = (CharToHex(data[i * 2]) << 4) | CharToHex(data[i * 2 + 1]);
+    }
+    return count;
+}
+
 std::string Ml307AtModem::EncodeHex(const std::string& data) {
     std::string encoded;
     EncodeHexAppend(encoded, data.c_str(), data.size());
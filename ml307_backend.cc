@@ -0,0 +1,85 @@
+#include "ml307_backend.h"
+#include "ml307_ssl_transport.h"
+#include "ml307_http.h"
+#include "ml307_mqtt.h"
+#include "ml307_udp.h"
+
+#include <esp_log.h>
+
+static const char *TAG = "Ml307Backend";
+
+int Ml307IdPool::Acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t id = 0; id < used_.size(); id++) {
+        if (!used_[id]) {
+            used_[id] = true;
+            return id;
+        }
+    }
+    return -1;
+}
+
+void Ml307IdPool::Release(int id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id >= 0 && id < (int)used_.size()) {
+        used_[id] = false;
+    }
+}
+
+// 持有一个连接 ID，作为第一个基类最后析构，保证协议对象关闭连接之后才归还 ID
+class Ml307IdLease {
+public:
+    Ml307IdLease(std::shared_ptr<Ml307IdPool> pool, int id) : pool_(std::move(pool)), id_(id) {}
+    ~Ml307IdLease() { pool_->Release(id_); }
+
+protected:
+    std::shared_ptr<Ml307IdPool> pool_;
+    int id_;
+};
+
+template <typename T>
+class Ml307Leased : private Ml307IdLease, public T {
+public:
+    Ml307Leased(Ml307AtModem& modem, std::shared_ptr<Ml307IdPool> pool, int id) : Ml307IdLease(std::move(pool), id), T(modem, id) {}
+};
+
+template <typename T>
+static T* CreateLeased(Ml307AtModem& modem, const std::shared_ptr<Ml307IdPool>& pool, const char* type) {
+    int id = pool->Acquire();
+    if (id < 0) {
+        ESP_LOGE(TAG, "No free connection id for %s", type);
+        return nullptr;
+    }
+    return new Ml307Leased<T>(modem, pool, id);
+}
+
+Ml307Backend::Ml307Backend(Ml307AtModem& modem) : modem_(modem),
+    connection_ids_(std::make_shared<Ml307IdPool>(ML307_MAX_CONNECTIONS)),
+    mqtt_ids_(std::make_shared<Ml307IdPool>(ML307_MAX_MQTT_CONNECTIONS)) {
+}
+
+bool Ml307Backend::IsReady() {
+    return modem_.network_ready();
+}
+
+Transport* Ml307Backend::CreateTlsTransport() {
+    return CreateLeased<Ml307SslTransport>(modem_, connection_ids_, "TLS");
+}
+
+Http* Ml307Backend::CreateHttp() {
+    return new Ml307Http(modem_);
+}
+
+Mqtt* Ml307Backend::CreateMqtt() {
+    return CreateLeased<Ml307Mqtt>(modem_, mqtt_ids_, "MQTT");
+}
+
+Udp* Ml307Backend::CreateUdp() {
+    return CreateLeased<Ml307Udp>(modem_, connection_ids_, "UDP");
+}
+
+UdpEndpoint* Ml307Backend::CreateUdpEndpoint() {
+    // Ml307UdpEndpoint 的指令格式是推断的，验证前不通过后端提供
+    ESP_LOGW(TAG, "UDP endpoint is not supported on ML307 yet");
+    return nullptr;
+}
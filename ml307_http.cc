@@ -158,9 +158,12 @@ bool Ml307Http::Open(const std::string& method, const std::string& url, const st
     }
 
     if (!content.empty() && method_ == "POST") {
+        // 请求体在 "> " 提示符之后原样发送
         sprintf(command, "AT+MHTTPCONTENT=%d,0,%zu", http_id_, content.size());
-        modem_.Command(command);
-        modem_.Command(content);
+        if (!modem_.CommandWithData(command, content.data(), content.size())) {
+            ESP_LOGE(TAG, "发送HTTP请求体失败");
+            return false;
+        }
     }
 
     // Set HEX encoding ON
@@ -1,5 +1,7 @@
 #include "ml307_mqtt.h"
 #include <esp_log.h>
+#include <algorithm>
+#include <chrono>
 
 static const char *TAG = "Ml307Mqtt";
 
@@ -12,48 +14,115 @@ Ml307Mqtt::Ml307Mqtt(Ml307AtModem& modem, int mqtt_id) : modem_(modem), mqtt_id_
                 auto type = arguments[0].string_value;
                 if (type == "conn") {
                     if (arguments[2].int_value == 0) {
+                        // 模组自动重连成功时也会上报，此时由 URC 直接恢复连接状态
+                        if (!connected_ && !connecting_) {
+                            connected_ = true;
+                            reconnect_pending_ = false;
+                            // 新会话需要重新订阅，不能在 URC 回调中发送 AT 命令，交给 worker 处理
+                            resubscribe_pending_ = clean_session_;
+                            connected_callback_pending_ = true;
+                            xEventGroupSetBits(event_group_handle_, MQTT_WORKER_WAKE_EVENT);
+                        }
                         xEventGroupSetBits(event_group_handle_, MQTT_CONNECTED_EVENT);
                     } else {
                         if (connected_) {
                             connected_ = false;
-                            if (on_disconnected_callback_) {
-                                on_disconnected_callback_();
-                            }
+                            disconnected_callback_pending_ = true;
+                            xEventGroupSetBits(event_group_handle_, MQTT_WORKER_WAKE_EVENT);
+                        }
+                        // 1 表示模组正在自动重连；持久会话的 QoS1 消息由 Broker 恢复，重连后继续重传
+                        if (arguments[2].int_value != 1 && clean_session_) {
+                            FailInFlightMessages();
+                        }
+                        if (auto_reconnect_ && !user_disconnect_ && !connecting_ && !reconnect_pending_) {
+                            reconnect_pending_ = true;
+                            reconnect_backoff_ms_ = reconnect_min_backoff_ms_;
+                            next_reconnect_tick_ = xTaskGetTickCount() + pdMS_TO_TICKS(reconnect_backoff_ms_);
+                            xEventGroupSetBits(event_group_handle_, MQTT_WORKER_WAKE_EVENT);
                         }
                         xEventGroupSetBits(event_group_handle_, MQTT_DISCONNECTED_EVENT);
                     }
                     ESP_LOGI(TAG, "MQTT connection state: %s", ErrorToString(arguments[2].int_value).c_str());
                 } else if (type == "suback") {
+                    // +MQTTURC: "suback",<id>,<msg_id>,<granted_qos>[,<granted_qos>...]
+                    if (arguments.size() >= 3) {
+                        std::lock_guard<std::mutex> lock(suback_mutex_);
+                        if (subscribing_) {
+                            auto& codes = suback_results_[arguments[2].int_value];
+                            codes.clear();
+                            for (size_t i = 3; i < arguments.size(); i++) {
+                                codes.push_back(arguments[i].int_value);
+                            }
+                        }
+                    }
+                    xEventGroupSetBits(event_group_handle_, MQTT_SUBACK_EVENT);
+                } else if (type == "puback") {
+                    // +MQTTURC: "puback",<id>,<packet_id>
+                    OnPublishAcknowledged(arguments.size() >= 3 ? arguments[2].int_value : -1);
                 } else if (type == "publish" && arguments.size() >= 7) {
-                    auto topic = arguments[3].string_value;
+                    // +MQTTURC: "publish",<id>,<packet_id>,<topic>,<total_len>,<cur_len>,<payload>
+                    auto& topic = arguments[3].string_value;
+                    auto& data = arguments[6].string_value;
                     if (arguments[4].int_value == arguments[5].int_value) {
-                        if (on_message_callback_) {
-                            on_message_callback_(topic, modem_.DecodeHex(arguments[6].string_value));
-                        }
+                        DispatchMessage(topic, modem_.DecodeHex(data));
                     } else {
-                        message_payload_.append(modem_.DecodeHex(arguments[6].string_value));
-                        if (message_payload_.size() >= arguments[4].int_value && on_message_callback_) {
-                            on_message_callback_(topic, message_payload_);
-                            message_payload_.clear();
+                        auto key = std::to_string(arguments[2].int_value) + ":" + topic;
+                        auto message = assembler_.Get(key, topic, arguments[4].int_value);
+                        if (message != nullptr) {
+                            modem_.DecodeHexAppend(message->payload, data.c_str(), data.size());
+                            if (message->payload.size() >= message->total_length) {
+                                DispatchMessage(message->topic, message->payload);
+                                assembler_.Remove(key);
+                            }
                         }
                     }
                 } else {
                     ESP_LOGI(TAG, "unhandled MQTT event: %s", type.c_str());
                 }
             }
+        } else if (command == "MQTTPUB" && arguments.size() >= 2) {
+            // +MQTTPUB: <id>,<packet_id>，在 OK 之前返回本次发送分配的报文 ID
+            if (arguments[0].int_value == mqtt_id_) {
+                OnPublishSent(arguments[1].int_value);
+            }
+        } else if (command == "MQTTSUB" && arguments.size() >= 2) {
+            // +MQTTSUB: <id>,<msg_id>，在 OK 之前返回本次订阅的报文 ID
+            if (arguments[0].int_value == mqtt_id_) {
+                std::lock_guard<std::mutex> lock(suback_mutex_);
+                subscribe_msg_id_ = arguments[1].int_value;
+            }
         } else if (command == "MQTTSTATE" && arguments.size() == 1) {
             connected_ = arguments[0].int_value != 3;
             xEventGroupSetBits(event_group_handle_, MQTT_INITIALIZED_EVENT);
         }
     });
+
+    auto ret = xTaskCreate([](void* arg) {
+        auto mqtt = (Ml307Mqtt*)arg;
+        mqtt->WorkerTask();
+        xEventGroupSetBits(mqtt->event_group_handle_, MQTT_WORKER_EXIT_EVENT);
+        vTaskDelete(NULL);
+    }, "mqtt_worker", 4096, this, 4, &worker_task_handle_);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create MQTT worker task");
+        worker_task_handle_ = nullptr;
+    }
 }
 
 Ml307Mqtt::~Ml307Mqtt() {
+    stopping_ = true;
+    if (worker_task_handle_ != nullptr) {
+        xEventGroupSetBits(event_group_handle_, MQTT_WORKER_WAKE_EVENT);
+        xEventGroupWaitBits(event_group_handle_, MQTT_WORKER_EXIT_EVENT, pdTRUE, pdFALSE, portMAX_DELAY);
+    }
     modem_.UnregisterCommandResponseCallback(command_callback_it_);
+    FailInFlightMessages();
+    // worker 已经退出，剩余的回调在这里调用
+    RunCompletions();
     vEventGroupDelete(event_group_handle_);
 }
 
-bool Ml307Mqtt::Connect(const std::string broker_address, int broker_port, const std::string client_id, const std::string username, const std::string password) {
+bool Ml307Mqtt::Connect(const std::string& broker_address, int broker_port, const std::string& client_id, const std::string& username, const std::string& password) {
     broker_address_ = broker_address;
     broker_port_ = broker_port;
     client_id_ = client_id;
@@ -61,7 +130,8 @@ bool Ml307Mqtt::Connect(const std::string broker_address, int broker_port, const
     password_ = password;
 
     EventBits_t bits;
-    if (IsConnected()) {
+    // 模组上可能残留上次运行的连接，这里需要向模组查询一次真实状态
+    if (Refresh()) {
         // 断开之前的连接
         Disconnect();
         bits = xEventGroupWaitBits(event_group_handle_, MQTT_DISCONNECTED_EVENT, pdTRUE, pdFALSE, pdMS_TO_TICKS(MQTT_CONNECT_TIMEOUT_MS));
@@ -71,6 +141,26 @@ bool Ml307Mqtt::Connect(const std::string broker_address, int broker_port, const
         }
     }
 
+    user_disconnect_ = false;
+    reconnect_pending_ = false;
+    connecting_ = true;
+    bool success = ConnectInternal();
+    connecting_ = false;
+    if (!success) {
+        return false;
+    }
+
+    connected_ = true;
+    Resubscribe();
+    if (on_connected_callback_) {
+        on_connected_callback_();
+    }
+    return true;
+}
+
+bool Ml307Mqtt::ConnectInternal() {
+    xEventGroupClearBits(event_group_handle_, MQTT_CONNECTED_EVENT | MQTT_DISCONNECTED_EVENT);
+
     if (broker_port_ == 8883) {
         if (!modem_.Command(std::string("AT+MQTTCFG=\"ssl\",") + std::to_string(mqtt_id_) + ",1")) {
             ESP_LOGE(TAG, "Failed to set MQTT to use SSL");
@@ -79,7 +169,7 @@ bool Ml307Mqtt::Connect(const std::string broker_address, int broker_port, const
     }
 
     // Set clean session
-    if (!modem_.Command(std::string("AT+MQTTCFG=\"clean\",") + std::to_string(mqtt_id_) + ",1")) {
+    if (!modem_.Command(std::string("AT+MQTTCFG=\"clean\",") + std::to_string(mqtt_id_) + (clean_session_ ? ",1" : ",0"))) {
         ESP_LOGE(TAG, "Failed to set MQTT clean session");
         return false;
     }
@@ -90,8 +180,8 @@ bool Ml307Mqtt::Connect(const std::string broker_address, int broker_port, const
         return false;
     }
 
-    // Set HEX encoding
-    if (!modem_.Command("AT+MQTTCFG=\"encoding\"," + std::to_string(mqtt_id_) + ",1,1")) {
+    // Set HEX encoding，原始发布模式下只对接收使用 HEX，保证 URC 行内不出现二进制数据
+    if (!modem_.Command("AT+MQTTCFG=\"encoding\"," + std::to_string(mqtt_id_) + (raw_publish_ ? ",0,1" : ",1,1"))) {
         ESP_LOGE(TAG, "Failed to set MQTT to use HEX encoding");
         return false;
     }
@@ -104,21 +194,22 @@ bool Ml307Mqtt::Connect(const std::string broker_address, int broker_port, const
     }
 
     // 等待连接完成
-    bits = xEventGroupWaitBits(event_group_handle_, MQTT_CONNECTED_EVENT | MQTT_DISCONNECTED_EVENT, pdTRUE, pdFALSE, pdMS_TO_TICKS(MQTT_CONNECT_TIMEOUT_MS));
+    auto bits = xEventGroupWaitBits(event_group_handle_, MQTT_CONNECTED_EVENT | MQTT_DISCONNECTED_EVENT, pdTRUE, pdFALSE, pdMS_TO_TICKS(MQTT_CONNECT_TIMEOUT_MS));
     if (!(bits & MQTT_CONNECTED_EVENT)) {
         ESP_LOGE(TAG, "Failed to connect to MQTT broker");
         return false;
     }
-
-    connected_ = true;
-    if (on_connected_callback_) {
-        on_connected_callback_();
-    }
     return true;
 }
 
 bool Ml307Mqtt::IsConnected() {
+    // 连接状态由 +MQTTURC: "conn" 维护，不访问模组
+    return connected_;
+}
+
+bool Ml307Mqtt::Refresh() {
     // 检查这个 id 是否已经连接
+    xEventGroupClearBits(event_group_handle_, MQTT_INITIALIZED_EVENT);
     modem_.Command(std::string("AT+MQTTSTATE=") + std::to_string(mqtt_id_));
     auto bits = xEventGroupWaitBits(event_group_handle_, MQTT_INITIALIZED_EVENT, pdTRUE, pdFALSE, pdMS_TO_TICKS(MQTT_CONNECT_TIMEOUT_MS));
     if (!(bits & MQTT_INITIALIZED_EVENT)) {
@@ -129,34 +220,461 @@ bool Ml307Mqtt::IsConnected() {
 }
 
 void Ml307Mqtt::Disconnect() {
+    user_disconnect_ = true;
+    reconnect_pending_ = false;
     if (!connected_) {
         return;
     }
     modem_.Command(std::string("AT+MQTTDISC=") + std::to_string(mqtt_id_));
 }
 
-bool Ml307Mqtt::Publish(const std::string topic, const std::string payload, int qos) {
+bool Ml307Mqtt::Publish(std::string_view topic, std::string_view payload, int qos) {
+    return PublishAsync(topic, payload, qos) >= 0;
+}
+
+bool Ml307Mqtt::SetRawPublish(bool enable) {
+    // 与 SendPublish 互斥，保证发送时的编码方式和模组配置一致
+    std::lock_guard<std::mutex> send_lock(send_mutex_);
+    if (enable == raw_publish_) {
+        return true;
+    }
+    if (connected_) {
+        if (!modem_.Command("AT+MQTTCFG=\"encoding\"," + std::to_string(mqtt_id_) + (enable ? ",0,1" : ",1,1"))) {
+            ESP_LOGE(TAG, "Failed to change MQTT publish encoding");
+            return false;
+        }
+    }
+    raw_publish_ = enable;
+    return true;
+}
+
+void Ml307Mqtt::SetPublishWindow(size_t window) {
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    publish_window_ = window > 0 ? window : 1;
+    publish_cv_.notify_all();
+}
+
+void Ml307Mqtt::SetPublishRetry(int timeout_ms, int max_retries) {
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    publish_timeout_ms_ = timeout_ms;
+    max_publish_retries_ = max_retries;
+}
+
+size_t Ml307Mqtt::GetInFlightCount() {
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    return in_flight_.size();
+}
+
+int Ml307Mqtt::PublishAsync(std::string_view topic, std::string_view payload, int qos, MqttPublishCallback callback) {
     if (!connected_) {
+        return -1;
+    }
+
+    // 分配消息 ID 和发送在同一把 send_mutex_ 内完成，发送顺序与消息 ID 顺序一致
+    std::unique_lock<std::mutex> send_lock(send_mutex_, std::defer_lock);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(publish_timeout_ms_);
+    int message_id = -1;
+    while (message_id < 0) {
+        if (qos > 0) {
+            // 等待发送窗口空出，此时不持有 send_mutex_，重传不受影响
+            std::unique_lock<std::mutex> lock(publish_mutex_);
+            bool ready = publish_cv_.wait_until(lock, deadline, [this] {
+                return in_flight_.size() < publish_window_ || !connected_;
+            });
+            if (!ready || !connected_) {
+                ESP_LOGW(TAG, "Publish window full, message dropped");
+                return -1;
+            }
+        }
+
+        send_lock.lock();
+        std::lock_guard<std::mutex> lock(publish_mutex_);
+        if (!connected_) {
+            return -1;
+        }
+        if (qos > 0 && in_flight_.size() >= publish_window_) {
+            // 窗口被其它发布者抢先占用，重新等待
+            send_lock.unlock();
+            continue;
+        }
+        message_id = next_message_id_++;
+        if (qos > 0) {
+            // 只有需要重传的 QoS1 消息才保留副本
+            in_flight_.push_back({message_id, std::string(topic), std::string(payload), qos, 0, xTaskGetTickCount(), callback, {}, false});
+        }
+    }
+
+    bool success = SendPublish(message_id, topic, payload, qos);
+    send_lock.unlock();
+    {
+        std::lock_guard<std::mutex> lock(publish_mutex_);
+        for (auto it = in_flight_.begin(); it != in_flight_.end(); ++it) {
+            if (it->message_id == message_id) {
+                if (success) {
+                    it->sent = true;
+                    it->sent_tick = xTaskGetTickCount();
+                } else {
+                    in_flight_.erase(it);
+                    publish_cv_.notify_all();
+                }
+                break;
+            }
+        }
+        if (success && qos == 0 && callback) {
+            completions_.push_back({message_id, true, callback});
+        }
+    }
+    if (!success) {
+        return -1;
+    }
+    if (qos == 0 && callback) {
+        xEventGroupSetBits(event_group_handle_, MQTT_WORKER_WAKE_EVENT);
+    }
+    return message_id;
+}
+
+bool Ml307Mqtt::SendPublish(int message_id, std::string_view topic, std::string_view payload, int qos) {
+    // 调用者持有 send_mutex_：模组一次只处理一条命令，+MQTTPUB 返回的报文 ID 对应 sending_message_id_
+    {
+        std::lock_guard<std::mutex> lock(publish_mutex_);
+        sending_message_id_ = message_id;
+    }
+
+    // 重发时模组会分配新的报文 ID，对 Broker 来说是一条新消息，因此不设置 DUP
+    std::string command;
+    command.reserve(48 + topic.size() + (raw_publish_ ? 0 : payload.size() * 2));
+    command += "AT+MQTTPUB=" + std::to_string(mqtt_id_) + ",\"";
+    command += topic;
+    command += "\"," + std::to_string(qos) + ",0,0,";
+    command += std::to_string(payload.size());
+    bool success;
+    if (raw_publish_) {
+        success = modem_.CommandWithData(command, payload.data(), payload.size());
+    } else {
+        command += ",";
+        modem_.EncodeHexAppend(command, payload.data(), payload.size());
+        success = modem_.Command(command);
+    }
+
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    sending_message_id_ = -1;
+    return success;
+}
+
+void Ml307Mqtt::OnPublishSent(int packet_id) {
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    packet_ids_reported_ = true;
+    for (auto& message : in_flight_) {
+        if (message.message_id == sending_message_id_) {
+            message.packet_ids.push_back(packet_id);
+            break;
+        }
+    }
+}
+
+void Ml307Mqtt::OnPublishAcknowledged(int packet_id) {
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    auto it = in_flight_.end();
+    if (packet_id >= 0) {
+        it = std::find_if(in_flight_.begin(), in_flight_.end(), [packet_id](const InFlightMessage& message) {
+            return std::find(message.packet_ids.begin(), message.packet_ids.end(), packet_id) != message.packet_ids.end();
+        });
+    }
+    if (it == in_flight_.end()) {
+        if (packet_id >= 0 && packet_ids_reported_) {
+            // 模组会上报报文 ID，找不到说明是重发产生的重复 PUBACK，对应的消息已经完成
+            return;
+        }
+        // 模组没有上报报文 ID 时，PUBACK 按发送顺序对应最早的已发送消息（MQTT 3.1.1 4.6）
+        it = std::find_if(in_flight_.begin(), in_flight_.end(), [](const InFlightMessage& message) {
+            return message.sent && message.packet_ids.empty();
+        });
+        if (it == in_flight_.end()) {
+            return;
+        }
+    }
+    completions_.push_back({it->message_id, true, std::move(it->callback)});
+    in_flight_.erase(it);
+    publish_cv_.notify_all();
+    xEventGroupSetBits(event_group_handle_, MQTT_WORKER_WAKE_EVENT);
+}
+
+void Ml307Mqtt::FailInFlightMessages() {
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    for (auto& message : in_flight_) {
+        completions_.push_back({message.message_id, false, std::move(message.callback)});
+    }
+    in_flight_.clear();
+    publish_cv_.notify_all();
+    xEventGroupSetBits(event_group_handle_, MQTT_WORKER_WAKE_EVENT);
+}
+
+void Ml307Mqtt::RunCompletions() {
+    std::deque<PublishCompletion> completions;
+    {
+        std::lock_guard<std::mutex> lock(publish_mutex_);
+        completions.swap(completions_);
+    }
+    for (auto& completion : completions) {
+        if (!completion.success) {
+            ESP_LOGW(TAG, "Message %d not acknowledged", completion.message_id);
+        }
+        if (completion.callback) {
+            completion.callback(completion.message_id, completion.success);
+        }
+    }
+}
+
+void Ml307Mqtt::RetransmitExpiredMessages() {
+    struct Resend {
+        int message_id;
+        std::string topic;
+        std::string payload;
+        int qos;
+    };
+    std::vector<Resend> resend;
+    {
+        std::lock_guard<std::mutex> lock(publish_mutex_);
+        if (in_flight_.empty() || !connected_) {
+            return;
+        }
+        // 每条消息单独计时，PUBACK 按报文 ID 匹配，不需要整窗重发
+        auto now = xTaskGetTickCount();
+        for (auto it = in_flight_.begin(); it != in_flight_.end();) {
+            if (!it->sent || now - it->sent_tick < pdMS_TO_TICKS(publish_timeout_ms_)) {
+                ++it;
+                continue;
+            }
+            if (it->retries >= max_publish_retries_) {
+                completions_.push_back({it->message_id, false, std::move(it->callback)});
+                it = in_flight_.erase(it);
+                publish_cv_.notify_all();
+                continue;
+            }
+            it->retries++;
+            it->sent_tick = now;
+            resend.push_back({it->message_id, it->topic, it->payload, it->qos});
+            ++it;
+        }
+    }
+
+    for (auto& message : resend) {
+        std::lock_guard<std::mutex> send_lock(send_mutex_);
+        if (!SendPublish(message.message_id, message.topic, message.payload, message.qos)) {
+            ESP_LOGW(TAG, "Failed to retransmit message %d", message.message_id);
+            break;
+        }
+    }
+}
+
+void Ml307Mqtt::Resubscribe() {
+    resubscribe_pending_ = false;
+    auto subscriptions = GetSubscribedTopics();
+    if (subscriptions.empty()) {
+        return;
+    }
+    if (!SubscribeMultiple(subscriptions)) {
+        for (auto& subscription : subscriptions) {
+            if (subscription.granted_qos < 0 || subscription.granted_qos == MQTT_SUBACK_FAILURE) {
+                ESP_LOGW(TAG, "Failed to resubscribe to %s", subscription.filter.c_str());
+            }
+        }
+    }
+}
+
+void Ml307Mqtt::TryReconnect() {
+    ESP_LOGI(TAG, "Reconnecting to %s:%d", broker_address_.c_str(), broker_port_);
+    connecting_ = true;
+    bool success = ConnectInternal();
+    connecting_ = false;
+    if (!reconnect_pending_) {
+        // 重连期间用户调用了 Disconnect 或 Connect
+        return;
+    }
+
+    if (!success) {
+        reconnect_backoff_ms_ = std::min(reconnect_backoff_ms_ * 2, reconnect_max_backoff_ms_);
+        next_reconnect_tick_ = xTaskGetTickCount() + pdMS_TO_TICKS(reconnect_backoff_ms_);
+        ESP_LOGW(TAG, "Reconnect failed, retry in %d ms", reconnect_backoff_ms_);
+        return;
+    }
+
+    reconnect_pending_ = false;
+    connected_ = true;
+    Resubscribe();
+    if (on_connected_callback_) {
+        on_connected_callback_();
+    }
+}
+
+void Ml307Mqtt::WorkerTask() {
+    while (!stopping_) {
+        xEventGroupWaitBits(event_group_handle_, MQTT_WORKER_WAKE_EVENT, pdTRUE, pdFALSE, pdMS_TO_TICKS(500));
+        if (stopping_) {
+            break;
+        }
+        RetransmitExpiredMessages();
+        RunCompletions();
+        if (disconnected_callback_pending_.exchange(false) && on_disconnected_callback_) {
+            on_disconnected_callback_();
+        }
+        if (resubscribe_pending_ && connected_) {
+            Resubscribe();
+        }
+        if (connected_callback_pending_.exchange(false) && connected_ && on_connected_callback_) {
+            on_connected_callback_();
+        }
+        if (reconnect_pending_ && !connected_ && (int32_t)(xTaskGetTickCount() - next_reconnect_tick_) >= 0) {
+            TryReconnect();
+        }
+    }
+}
+
+bool Ml307Mqtt::Subscribe(const std::string& topic, int qos) {
+    std::vector<MqttSubscription> subscriptions = {{topic, qos}};
+    return SubscribeMultiple(subscriptions);
+}
+
+bool Ml307Mqtt::SendSubscribe(const std::vector<MqttSubscription>& subscriptions, size_t start, size_t end, int& msg_id) {
+    std::string command = "AT+MQTTSUB=" + std::to_string(mqtt_id_);
+    for (size_t i = start; i < end; i++) {
+        command += ",\"" + subscriptions[i].filter + "\"," + std::to_string(subscriptions[i].qos);
+    }
+    {
+        std::lock_guard<std::mutex> lock(suback_mutex_);
+        subscribe_msg_id_ = -1;
+    }
+    if (!modem_.Command(command)) {
         return false;
     }
-    std::string command = "AT+MQTTPUB=" + std::to_string(mqtt_id_) + ",\"" + topic + "\",";
-    command += std::to_string(qos) + ",0,0,";
-    command += std::to_string(payload.size()) + "," + modem_.EncodeHex(payload);
-    return modem_.Command(command);
+    std::lock_guard<std::mutex> lock(suback_mutex_);
+    msg_id = subscribe_msg_id_;
+    return true;
 }
 
-bool Ml307Mqtt::Subscribe(const std::string topic, int qos) {
+bool Ml307Mqtt::SubscribeMultiple(std::vector<MqttSubscription>& subscriptions) {
     if (!connected_) {
         return false;
     }
-    std::string command = "AT+MQTTSUB=" + std::to_string(mqtt_id_) + ",\"" + topic + "\"," + std::to_string(qos);
-    return modem_.Command(command);
+
+    struct SubscribeBatch {
+        size_t start;
+        size_t end;
+        int msg_id;
+        bool done;
+    };
+
+    std::lock_guard<std::mutex> lock(subscribe_mutex_);
+    {
+        std::lock_guard<std::mutex> suback_lock(suback_mutex_);
+        suback_results_.clear();
+        subscribing_ = true;
+    }
+
+    // 先把所有 SUBSCRIBE 发出去，再统一等待 SUBACK，多个批次只需要一次往返时间
+    std::vector<SubscribeBatch> batches;
+    bool success = true;
+    size_t start = 0;
+    while (start < subscriptions.size()) {
+        size_t count = multi_topic_subscribe_ ? MQTT_MAX_TOPICS_PER_SUBSCRIBE : 1;
+        size_t end = std::min(start + count, subscriptions.size());
+        int msg_id = -1;
+        if (SendSubscribe(subscriptions, start, end, msg_id)) {
+            batches.push_back({start, end, msg_id, false});
+            start = end;
+            continue;
+        }
+        if (end - start > 1) {
+            // 固件不支持一条命令订阅多个主题，改为逐个订阅并从这一批重新开始
+            ESP_LOGW(TAG, "Multi-topic subscribe rejected, falling back to one topic per command");
+            multi_topic_subscribe_ = false;
+            continue;
+        }
+        subscriptions[start].granted_qos = MQTT_SUBACK_FAILURE;
+        success = false;
+        start = end;
+    }
+
+    // 按报文 ID 对应结果，之前超时批次迟到的 SUBACK 不会被算到这一批
+    // 模组没有上报报文 ID 的批次按顺序取报文 ID 最小的未认领结果
+    auto deadline = xTaskGetTickCount() + pdMS_TO_TICKS(MQTT_SUBSCRIBE_TIMEOUT_MS);
+    size_t remaining = batches.size();
+    while (remaining > 0) {
+        {
+            std::lock_guard<std::mutex> suback_lock(suback_mutex_);
+            for (auto& batch : batches) {
+                if (batch.done) {
+                    continue;
+                }
+                auto it = suback_results_.end();
+                if (batch.msg_id >= 0) {
+                    it = suback_results_.find(batch.msg_id);
+                } else {
+                    for (it = suback_results_.begin(); it != suback_results_.end(); ++it) {
+                        bool claimed = std::any_of(batches.begin(), batches.end(), [&it](const SubscribeBatch& other) {
+                            return other.msg_id == it->first;
+                        });
+                        if (!claimed) {
+                            break;
+                        }
+                    }
+                }
+                if (it == suback_results_.end()) {
+                    continue;
+                }
+
+                auto& codes = it->second;
+                size_t count = batch.end - batch.start;
+                for (size_t i = batch.start; i < batch.end; i++) {
+                    // 结果数量和过滤器数量不一致时无法判断哪个主题成功，全部视为失败
+                    int code = codes.size() == count ? codes[i - batch.start] : MQTT_SUBACK_FAILURE;
+                    subscriptions[i].granted_qos = code;
+                    if (code == MQTT_SUBACK_FAILURE) {
+                        success = false;
+                    } else {
+                        RememberSubscription(subscriptions[i].filter, subscriptions[i].qos);
+                    }
+                }
+                if (codes.size() != count) {
+                    ESP_LOGW(TAG, "SUBACK has %u codes for %u topics", (unsigned)codes.size(), (unsigned)count);
+                }
+                suback_results_.erase(it);
+                batch.done = true;
+                remaining--;
+            }
+        }
+        if (remaining == 0) {
+            break;
+        }
+        auto now = xTaskGetTickCount();
+        if ((int32_t)(deadline - now) <= 0) {
+            break;
+        }
+        xEventGroupWaitBits(event_group_handle_, MQTT_SUBACK_EVENT, pdTRUE, pdFALSE, deadline - now);
+    }
+
+    for (auto& batch : batches) {
+        if (batch.done) {
+            continue;
+        }
+        ESP_LOGW(TAG, "No SUBACK for %s", subscriptions[batch.start].filter.c_str());
+        for (size_t i = batch.start; i < batch.end; i++) {
+            subscriptions[i].granted_qos = MQTT_SUBACK_FAILURE;
+        }
+        success = false;
+    }
+
+    std::lock_guard<std::mutex> suback_lock(suback_mutex_);
+    subscribing_ = false;
+    suback_results_.clear();
+    return success;
 }
 
-bool Ml307Mqtt::Unsubscribe(const std::string topic) {
+bool Ml307Mqtt::Unsubscribe(const std::string& topic) {
     if (!connected_) {
         return false;
     }
+    ForgetSubscription(topic);
     std::string command = "AT+MQTTUNSUB=" + std::to_string(mqtt_id_) + ",\"" + topic + "\"";
     return modem_.Command(command);
 }
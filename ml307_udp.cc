@@ -1,6 +1,7 @@
 #include "ml307_udp.h"
 
 #include <esp_log.h>
+#include <esp_timer.h>
 
 #define TAG "Ml307Udp"
 
@@ -32,8 +33,22 @@ Ml307Udp::Ml307Udp(Ml307AtModem& modem, int udp_id) : modem_(modem), udp_id_(udp
         } else if (command == "MIPURC" && arguments.size() == 4) {
             if (arguments[1].int_value == udp_id_) {
                 if (arguments[0].string_value == "rudp") {
-                    if (message_callback_) {
-                        message_callback_(modem_.DecodeHex(arguments[3].string_value));
+                    auto& data = arguments[3].string_value;
+                    DatagramBuffer buffer;
+                    if (buffer_callback_ && data.size() / 2 <= buffer_pool_->buffer_size()) {
+                        buffer = buffer_pool_->Acquire();
+                    }
+                    if (buffer) {
+                        // 直接解码到池化缓冲区
+                        buffer.set_size(modem_.DecodeHexTo(buffer.data(), buffer.capacity(), data.c_str(), data.size()));
+                        buffer_callback_(std::move(buffer));
+                    } else if (message_callback_) {
+                        message_callback_(modem_.DecodeHex(data));
+                    } else if (buffer_callback_) {
+                        // 没有 OnMessage 可以退回，只能丢弃；每 100 个打印一次，避免在 URC 回调中刷屏
+                        if (dropped_count_++ % 100 == 0) {
+                            ESP_LOGW(TAG, "No datagram buffer available, dropped %lu", (unsigned long)dropped_count_.load());
+                        }
                     }
                 } else if (arguments[0].string_value == "disconn") {
                     connected_ = false;
@@ -59,6 +74,14 @@ Ml307Udp::Ml307Udp(Ml307AtModem& modem, int udp_id) : modem_(modem), udp_id_(udp
 }
 
 Ml307Udp::~Ml307Udp() {
+    if (send_task_handle_ != nullptr) {
+        {
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            stopping_ = true;
+        }
+        send_cv_.notify_all();
+        xEventGroupWaitBits(event_group_handle_, ML307_UDP_SEND_TASK_EXIT, pdTRUE, pdFALSE, portMAX_DELAY);
+    }
     Disconnect();
     modem_.UnregisterCommandResponseCallback(command_callback_it_);
 }
@@ -128,15 +151,97 @@ int Ml307Udp::Send(const std::string& data) {
         return -1;
     }
 
-    // 在循环外预先分配command
-    std::string command = "AT+MIPSEND=" + std::to_string(udp_id_) + "," + std::to_string(data.size()) + ",";
-    
+    if (send_task_handle_ == nullptr) {
+        std::string command;
+        return SendNow(command, data.data(), data.size());
+    }
+
+    // 异步模式：入队后立即返回，不阻塞调用者（如音频编码任务）
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (send_queue_.size() >= send_queue_depth_) {
+            send_stats_.dropped++;
+            if (overflow_policy_ == UdpOverflowPolicy::DropNewest) {
+                return 0;
+            }
+            send_queue_.pop_front();
+        }
+        send_queue_.push_back({data, esp_timer_get_time()});
+        send_stats_.queued = send_queue_.size();
+    }
+    send_cv_.notify_one();
+    return data.size();
+}
+
+int Ml307Udp::SendNow(std::string& command, const char* data, size_t length) {
+    command.clear();
+    command += "AT+MIPSEND=" + std::to_string(udp_id_) + "," + std::to_string(length) + ",";
+
     // 直接在command字符串上进行十六进制编码
-    modem_.EncodeHexAppend(command, data.c_str(), data.size());
-    
+    modem_.EncodeHexAppend(command, data, length);
+
     if (!modem_.Command(command, 100)) {
         ESP_LOGE(TAG, "发送数据块失败");
         return -1;
     }
-    return data.size();
+    return length;
+}
+
+bool Ml307Udp::EnableSendQueue(size_t depth, UdpOverflowPolicy policy, int task_priority) {
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        send_queue_depth_ = depth > 0 ? depth : 1;
+        overflow_policy_ = policy;
+    }
+    if (send_task_handle_ != nullptr) {
+        return true;
+    }
+    BaseType_t ret = xTaskCreate([](void* arg) {
+        auto udp = (Ml307Udp*)arg;
+        udp->SendTask();
+        xEventGroupSetBits(udp->event_group_handle_, ML307_UDP_SEND_TASK_EXIT);
+        vTaskDelete(NULL);
+    }, "udp_send", 4096, this, task_priority, &send_task_handle_);
+    if (ret != pdPASS) {
+        // 没有发送任务时 Send 仍然同步发送，析构时也不会等待任务退出
+        ESP_LOGE(TAG, "Failed to create send task");
+        send_task_handle_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+UdpSendStats Ml307Udp::GetSendStats() {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    UdpSendStats stats = send_stats_;
+    stats.queued = send_queue_.size();
+    stats.average_latency_us = send_stats_.sent > 0 ? total_latency_us_ / send_stats_.sent : 0;
+    return stats;
+}
+
+void Ml307Udp::SendTask() {
+    std::unique_lock<std::mutex> lock(send_mutex_);
+    while (true) {
+        send_cv_.wait(lock, [this] { return stopping_ || !send_queue_.empty(); });
+        if (stopping_) {
+            break;
+        }
+        QueuedDatagram datagram = std::move(send_queue_.front());
+        send_queue_.pop_front();
+
+        lock.unlock();
+        int ret = connected_ ? SendNow(send_command_, datagram.data.data(), datagram.data.size()) : -1;
+        uint32_t latency_us = esp_timer_get_time() - datagram.enqueue_time_us;
+        lock.lock();
+
+        if (ret < 0) {
+            send_stats_.failed++;
+            continue;
+        }
+        send_stats_.sent++;
+        total_latency_us_ += latency_us;
+        if (latency_us > send_stats_.max_latency_us) {
+            send_stats_.max_latency_us = latency_us;
+        }
+    }
 }
@@ -0,0 +1,108 @@
+#include "ml307_udp_endpoint.h"
+
+#include <esp_log.h>
+
+#define TAG "Ml307UdpEndpoint"
+
+// UDP 服务模式的指令格式（按其它模组的 UDP SERVICE 用法推断，未在 ML307 固件上验证）：
+//   打开  AT+MIPOPEN=<id>,"UDP SERVICE","127.0.0.1",0,<local_port>,0
+//   发送  AT+MIPSEND=<id>,<len>,"<host>",<port>,<hex>
+//   接收  +MIPURC: "rudp",<id>,"<host>",<port>,<len>,<hex>
+
+Ml307UdpEndpoint::Ml307UdpEndpoint(Ml307AtModem& modem, int udp_id) : modem_(modem), udp_id_(udp_id) {
+    event_group_handle_ = xEventGroupCreate();
+
+    command_callback_it_ = modem_.RegisterCommandResponseCallback([this](const std::string& command, const std::vector<AtArgumentValue>& arguments) {
+        if (command == "MIPOPEN" && arguments.size() == 2) {
+            if (arguments[0].int_value == udp_id_) {
+                if (arguments[1].int_value == 0) {
+                    bound_ = true;
+                    xEventGroupClearBits(event_group_handle_, ML307_UDP_ENDPOINT_CLOSED | ML307_UDP_ENDPOINT_ERROR);
+                    xEventGroupSetBits(event_group_handle_, ML307_UDP_ENDPOINT_OPENED);
+                } else {
+                    bound_ = false;
+                    xEventGroupSetBits(event_group_handle_, ML307_UDP_ENDPOINT_ERROR);
+                }
+            }
+        } else if (command == "MIPCLOSE" && arguments.size() == 1) {
+            if (arguments[0].int_value == udp_id_) {
+                bound_ = false;
+                xEventGroupSetBits(event_group_handle_, ML307_UDP_ENDPOINT_CLOSED);
+            }
+        } else if (command == "MIPURC" && arguments.size() == 6) {
+            if (arguments[0].string_value == "rudp" && arguments[1].int_value == udp_id_) {
+                if (message_callback_) {
+                    message_callback_(arguments[2].string_value, arguments[3].int_value, modem_.DecodeHex(arguments[5].string_value));
+                }
+            }
+        } else if (command == "MIPURC" && arguments.size() >= 2) {
+            if (arguments[0].string_value == "disconn" && arguments[1].int_value == udp_id_) {
+                bound_ = false;
+                xEventGroupSetBits(event_group_handle_, ML307_UDP_ENDPOINT_CLOSED);
+            }
+        }
+    });
+}
+
+Ml307UdpEndpoint::~Ml307UdpEndpoint() {
+    Close();
+    modem_.UnregisterCommandResponseCallback(command_callback_it_);
+    vEventGroupDelete(event_group_handle_);
+}
+
+bool Ml307UdpEndpoint::Bind(int local_port) {
+    char command[96];
+
+    Close();
+    xEventGroupClearBits(event_group_handle_, ML307_UDP_ENDPOINT_OPENED | ML307_UDP_ENDPOINT_CLOSED | ML307_UDP_ENDPOINT_ERROR);
+
+    sprintf(command, "AT+MIPOPEN=%d,\"UDP SERVICE\",\"127.0.0.1\",0,%d,0", udp_id_, local_port);
+    if (!modem_.Command(command)) {
+        ESP_LOGE(TAG, "Failed to open UDP service on port %d", local_port);
+        return false;
+    }
+
+    // 使用 HEX 编码
+    sprintf(command, "AT+MIPCFG=\"encoding\",%d,1,1", udp_id_);
+    if (!modem_.Command(command)) {
+        ESP_LOGE(TAG, "Failed to set HEX encoding");
+        return false;
+    }
+
+    auto bits = xEventGroupWaitBits(event_group_handle_, ML307_UDP_ENDPOINT_OPENED | ML307_UDP_ENDPOINT_ERROR, pdTRUE, pdFALSE, pdMS_TO_TICKS(UDP_ENDPOINT_OPEN_TIMEOUT_MS));
+    if (!(bits & ML307_UDP_ENDPOINT_OPENED)) {
+        ESP_LOGE(TAG, "Failed to bind port %d", local_port);
+        return false;
+    }
+    return true;
+}
+
+void Ml307UdpEndpoint::Close() {
+    if (!bound_) {
+        return;
+    }
+    bound_ = false;
+    modem_.Command("AT+MIPCLOSE=" + std::to_string(udp_id_));
+}
+
+int Ml307UdpEndpoint::SendTo(const std::string& host, int port, const std::string& data) {
+    const size_t MAX_PACKET_SIZE = 1460 / 2;
+
+    if (!bound_) {
+        ESP_LOGE(TAG, "未绑定");
+        return -1;
+    }
+    if (data.size() > MAX_PACKET_SIZE) {
+        ESP_LOGE(TAG, "数据块超过最大限制");
+        return -1;
+    }
+
+    std::string command = "AT+MIPSEND=" + std::to_string(udp_id_) + "," + std::to_string(data.size())
+        + ",\"" + host + "\"," + std::to_string(port) + ",";
+    modem_.EncodeHexAppend(command, data.data(), data.size());
+    if (!modem_.Command(command, 100)) {
+        ESP_LOGE(TAG, "发送到 %s:%d 失败", host.c_str(), port);
+        return -1;
+    }
+    return data.size();
+}
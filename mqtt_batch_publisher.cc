@@ -0,0 +1,253 @@
+#include "mqtt_batch_publisher.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+static const char *TAG = "MqttBatch";
+
+// 逐条发布时每条消息额外的 PUBLISH 固定头（2 字节）和主题长度字段（2 字节）
+#define MQTT_PUBLISH_OVERHEAD 4
+
+static void AppendVarint(std::string& dest, uint32_t value) {
+    while (value >= 0x80) {
+        dest.push_back((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    dest.push_back((char)value);
+}
+
+MqttBatchPublisher::MqttBatchPublisher(Mqtt& mqtt, size_t max_batch_bytes, int max_delay_ms, int qos)
+    : mqtt_(mqtt), max_batch_bytes_(max_batch_bytes), max_delay_ms_(max_delay_ms), qos_(qos) {
+    start_time_us_ = esp_timer_get_time();
+    flush_thread_ = std::thread(&MqttBatchPublisher::FlushTask, this);
+}
+
+MqttBatchPublisher::~MqttBatchPublisher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (flush_thread_.joinable()) {
+        flush_thread_.join();
+    }
+    Flush();
+}
+
+bool MqttBatchPublisher::Add(const std::string& topic, const std::string& record) {
+    bool full = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& batch = batches_[topic];
+        // 加入本条会超过阈值时先把已有的记录封口
+        if (batch.records > 0 && batch.payload.size() + record.size() + 5 > max_batch_bytes_) {
+            SealLocked(topic, std::move(batch));
+            batch = Batch();
+        }
+        if (batch.records == 0) {
+            batch.payload.reserve(max_batch_bytes_);
+            batch.deadline_us = esp_timer_get_time() + max_delay_ms_ * 1000LL;
+            cv_.notify_all();
+        }
+        AppendVarint(batch.payload, record.size());
+        batch.payload.append(record);
+        batch.records++;
+        batch.record_bytes += record.size();
+        stats_.records++;
+        stats_.payload_bytes += record.size();
+        // 达到阈值的批次不再等待期限
+        if (batch.payload.size() >= max_batch_bytes_) {
+            SealLocked(topic, std::move(batch));
+            batches_.erase(topic);
+        }
+        full = ready_.count(topic) > 0;
+    }
+
+    // 记录已经被接受，发布失败的批次交给定时线程重试
+    if (full && !PublishReady(topic)) {
+        cv_.notify_all();
+    }
+    return true;
+}
+
+bool MqttBatchPublisher::Flush(const std::string& topic) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = batches_.find(topic);
+        if (it != batches_.end()) {
+            if (it->second.records > 0) {
+                SealLocked(topic, std::move(it->second));
+            }
+            batches_.erase(it);
+        }
+        if (ready_.count(topic) == 0) {
+            return true;
+        }
+    }
+    return PublishReady(topic);
+}
+
+bool MqttBatchPublisher::Flush() {
+    std::vector<std::string> topics;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& item : batches_) {
+            if (item.second.records > 0) {
+                SealLocked(item.first, std::move(item.second));
+            }
+        }
+        batches_.clear();
+        for (auto& item : ready_) {
+            topics.push_back(item.first);
+        }
+    }
+    bool success = true;
+    for (auto& topic : topics) {
+        if (!PublishReady(topic)) {
+            success = false;
+        }
+    }
+    return success;
+}
+
+void MqttBatchPublisher::SealLocked(const std::string& topic, Batch&& batch) {
+    // 调用者持有 mutex_
+    auto& queue = ready_[topic];
+    if (queue.size() >= MQTT_BATCH_MAX_PENDING) {
+        ESP_LOGW(TAG, "Dropping batch of %lu records to %s", (unsigned long)queue.front().records, topic.c_str());
+        queue.pop_front();
+        stats_.dropped_batches++;
+    }
+    queue.push_back(std::move(batch));
+}
+
+bool MqttBatchPublisher::PublishReady(const std::string& topic) {
+    std::lock_guard<std::mutex> publish_lock(publish_mutex_);
+    while (true) {
+        Batch batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = ready_.find(topic);
+            if (it == ready_.end()) {
+                return true;
+            }
+            batch = std::move(it->second.front());
+            it->second.pop_front();
+            if (it->second.empty()) {
+                ready_.erase(it);
+            }
+        }
+
+        if (!Publish(topic, batch)) {
+            // 放回队首，保持顺序，等待下次重试
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& queue = ready_[topic];
+            queue.push_front(std::move(batch));
+            if (queue.size() > MQTT_BATCH_MAX_PENDING) {
+                queue.pop_back();
+                stats_.dropped_batches++;
+            }
+            return false;
+        }
+    }
+}
+
+MqttBatchStats MqttBatchPublisher::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    MqttBatchStats stats = stats_;
+    int64_t elapsed_us = esp_timer_get_time() - start_time_us_;
+    stats.records_per_second = elapsed_us > 0 ? stats.records * 1000000.0f / elapsed_us : 0;
+    return stats;
+}
+
+bool MqttBatchPublisher::Publish(const std::string& topic, const Batch& batch) {
+    bool success = mqtt_.Publish(topic, batch.payload, qos_);
+    if (!success) {
+        ESP_LOGW(TAG, "Failed to publish batch of %lu records to %s", (unsigned long)batch.records, topic.c_str());
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.publish_failures++;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.batches++;
+    stats_.framed_bytes += batch.payload.size();
+    // 省下 records - 1 条消息的头部和主题，减去长度前缀的开销
+    int32_t saved = (int32_t)(batch.records - 1) * (int32_t)(MQTT_PUBLISH_OVERHEAD + topic.size());
+    int32_t framing = (int32_t)(batch.payload.size() - batch.record_bytes);
+    stats_.bytes_saved += saved - framing;
+    return true;
+}
+
+void MqttBatchPublisher::FlushTask() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        int64_t now = esp_timer_get_time();
+        int64_t next_deadline = INT64_MAX;
+        for (auto it = batches_.begin(); it != batches_.end();) {
+            if (it->second.records > 0 && it->second.deadline_us <= now) {
+                SealLocked(it->first, std::move(it->second));
+                it = batches_.erase(it);
+            } else {
+                if (it->second.records > 0 && it->second.deadline_us < next_deadline) {
+                    next_deadline = it->second.deadline_us;
+                }
+                ++it;
+            }
+        }
+
+        std::vector<std::string> topics;
+        for (auto& item : ready_) {
+            topics.push_back(item.first);
+        }
+        if (!topics.empty()) {
+            lock.unlock();
+            bool success = true;
+            for (auto& topic : topics) {
+                success = PublishReady(topic) && success;
+            }
+            lock.lock();
+            if (success) {
+                continue;
+            }
+            // 发布失败的批次留在待发队列中，隔一个期限再重试
+            next_deadline = std::min<int64_t>(next_deadline, now + max_delay_ms_ * 1000LL);
+        }
+
+        if (stopping_) {
+            break;
+        }
+        if (next_deadline == INT64_MAX) {
+            cv_.wait(lock);
+        } else {
+            cv_.wait_for(lock, std::chrono::microseconds(std::max<int64_t>(next_deadline - esp_timer_get_time(), 0)));
+        }
+    }
+}
+
+bool MqttBatchPublisher::Unpack(const std::string& payload, std::function<void(const char* data, size_t length)> callback) {
+    size_t offset = 0;
+    while (offset < payload.size()) {
+        uint32_t length = 0;
+        int shift = 0;
+        while (true) {
+            if (offset >= payload.size() || shift > 28) {
+                return false;
+            }
+            uint8_t byte = payload[offset++];
+            length |= (uint32_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                break;
+            }
+            shift += 7;
+        }
+        if (length > payload.size() - offset) {
+            return false;
+        }
+        callback(payload.data() + offset, length);
+        offset += length;
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+#include "mqtt_message_assembler.h"
+#include <esp_log.h>
+
+static const char *TAG = "MqttAssembler";
+
+MqttMessageAssembler::PartialMessage* MqttMessageAssembler::Get(const std::string& key, const std::string& topic, size_t total_length) {
+    auto it = partial_messages_.find(key);
+    if (it != partial_messages_.end()) {
+        return &it->second;
+    }
+
+    if (total_length > max_message_size_) {
+        ESP_LOGW(TAG, "Message on %s too large: %zu > %zu", topic.c_str(), total_length, max_message_size_);
+        return nullptr;
+    }
+
+    // 同时重组的消息数有上限，丢弃最早未完成的一条
+    if (partial_messages_.size() >= MQTT_MAX_PARTIAL_MESSAGES) {
+        auto oldest = partial_messages_.begin();
+        for (auto i = partial_messages_.begin(); i != partial_messages_.end(); ++i) {
+            if (i->second.sequence < oldest->second.sequence) {
+                oldest = i;
+            }
+        }
+        ESP_LOGW(TAG, "Dropping incomplete message on %s", oldest->second.topic.c_str());
+        partial_messages_.erase(oldest);
+    }
+
+    auto& message = partial_messages_[key];
+    message.topic = topic;
+    message.total_length = total_length;
+    message.sequence = next_sequence_++;
+    message.payload.reserve(total_length);
+    return &message;
+}
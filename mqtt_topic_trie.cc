@@ -0,0 +1,99 @@
+#include "mqtt_topic_trie.h"
+
+#include <string_view>
+
+void MqttTopicTrie::Insert(const std::string& filter, MqttMessageHandler handler) {
+    Node* node = &root_;
+    size_t start = 0;
+    while (true) {
+        size_t end = filter.find('/', start);
+        auto level = filter.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (level == "#") {
+            if (!node->multi_level_handler) {
+                size_++;
+            }
+            node->multi_level_handler = handler;
+            return;
+        }
+        auto& child = node->children[level];
+        if (!child) {
+            child = std::make_unique<Node>();
+        }
+        node = child.get();
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+    if (!node->handler) {
+        size_++;
+    }
+    node->handler = handler;
+}
+
+bool MqttTopicTrie::Remove(const std::string& filter) {
+    bool removed = false;
+    RemoveLevel(root_, filter, 0, removed);
+    if (removed) {
+        size_--;
+    }
+    return removed;
+}
+
+bool MqttTopicTrie::RemoveLevel(Node& node, const std::string& filter, size_t start, bool& removed) {
+    if (start == std::string::npos) {
+        removed = node.handler != nullptr;
+        node.handler = nullptr;
+    } else {
+        size_t end = filter.find('/', start);
+        std::string_view level(filter.data() + start, (end == std::string::npos ? filter.size() : end) - start);
+        if (level == "#") {
+            removed = node.multi_level_handler != nullptr;
+            node.multi_level_handler = nullptr;
+        } else {
+            auto it = node.children.find(level);
+            if (it == node.children.end()) {
+                return false;
+            }
+            // 子节点变空时一并删除
+            if (RemoveLevel(*it->second, filter, end == std::string::npos ? std::string::npos : end + 1, removed)) {
+                node.children.erase(it);
+            }
+        }
+    }
+    return node.children.empty() && !node.handler && !node.multi_level_handler;
+}
+
+void MqttTopicTrie::Match(const std::string& topic, std::vector<MqttMessageHandler>& handlers) const {
+    MatchLevel(root_, topic, 0, true, handlers);
+}
+
+void MqttTopicTrie::MatchLevel(const Node& node, const std::string& topic, size_t start, bool first_level, std::vector<MqttMessageHandler>& handlers) {
+    // 以 $ 开头的系统主题不匹配首层通配符（MQTT 3.1.1 4.7.2）
+    bool system_topic = first_level && !topic.empty() && topic[0] == '$';
+
+    if (node.multi_level_handler && !system_topic) {
+        handlers.push_back(node.multi_level_handler);
+    }
+    if (start == std::string::npos) {
+        if (node.handler) {
+            handlers.push_back(node.handler);
+        }
+        return;
+    }
+
+    size_t end = topic.find('/', start);
+    std::string_view level(topic.data() + start, (end == std::string::npos ? topic.size() : end) - start);
+    size_t next = end == std::string::npos ? std::string::npos : end + 1;
+
+    auto it = node.children.find(level);
+    if (it != node.children.end()) {
+        MatchLevel(*it->second, topic, next, false, handlers);
+    }
+    if (!system_topic && level != "+") {
+        auto plus = node.children.find(std::string_view("+"));
+        if (plus != node.children.end()) {
+            MatchLevel(*plus->second, topic, next, false, handlers);
+        }
+    }
+}
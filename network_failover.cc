@@ -0,0 +1,179 @@
+#include "network_failover.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+static const char *TAG = "NetworkFailover";
+
+NetworkFailover::NetworkFailover(NetworkBackend& primary, NetworkBackend& backup)
+    : primary_(primary, NETWORK_FAILOVER_PRIMARY_PROBE_INTERVAL_MS), backup_(backup, NETWORK_FAILOVER_BACKUP_PROBE_INTERVAL_MS) {
+    event_group_handle_ = xEventGroupCreate();
+}
+
+NetworkFailover::~NetworkFailover() {
+    Stop();
+    vEventGroupDelete(event_group_handle_);
+}
+
+void NetworkFailover::SetProbeTarget(const std::string& echo_host, int echo_port) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    echo_host_ = echo_host;
+    echo_port_ = echo_port;
+}
+
+void NetworkFailover::SetThresholds(uint32_t max_rtt_ms, float max_loss, int fail_hold_ms, int recover_hold_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_rtt_ms_ = max_rtt_ms;
+    max_loss_ = max_loss;
+    fail_hold_us_ = fail_hold_ms * 1000LL;
+    recover_hold_us_ = recover_hold_ms * 1000LL;
+}
+
+void NetworkFailover::OnSwitch(std::function<void(NetworkBackend& backend)> callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    on_switch_callback_ = callback;
+}
+
+void NetworkFailover::Start() {
+    if (monitor_task_handle_ != nullptr) {
+        return;
+    }
+    stopping_ = false;
+    xEventGroupClearBits(event_group_handle_, NETWORK_FAILOVER_TASK_EXIT);
+    xTaskCreate([](void* arg) {
+        auto failover = (NetworkFailover*)arg;
+        failover->MonitorTask();
+        xEventGroupSetBits(failover->event_group_handle_, NETWORK_FAILOVER_TASK_EXIT);
+        vTaskDelete(NULL);
+    }, "net_failover", 4096, this, 2, &monitor_task_handle_);
+}
+
+void NetworkFailover::Stop() {
+    if (monitor_task_handle_ == nullptr) {
+        return;
+    }
+    stopping_ = true;
+    xEventGroupWaitBits(event_group_handle_, NETWORK_FAILOVER_TASK_EXIT, pdTRUE, pdFALSE, portMAX_DELAY);
+    monitor_task_handle_ = nullptr;
+    StopProbe(primary_);
+    StopProbe(backup_);
+}
+
+NetworkBackend& NetworkFailover::Current() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return using_primary_ ? primary_.backend : backup_.backend;
+}
+
+LinkHealth NetworkFailover::GetPrimaryHealth() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return primary_.health;
+}
+
+LinkHealth NetworkFailover::GetBackupHealth() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return backup_.health;
+}
+
+void NetworkFailover::StopProbe(Link& link) {
+    // 先断开并清除回调，之后不会再有回显进入即将销毁的探测对象
+    if (link.udp) {
+        link.udp->Disconnect();
+        link.udp->OnMessage(nullptr);
+    }
+    if (link.probe) {
+        link.probe->Stop();
+        link.probe.reset();
+    }
+    link.udp.reset();
+}
+
+void NetworkFailover::UpdateLink(Link& link, int64_t now) {
+    // 只在监控任务中调用
+    std::string echo_host;
+    int echo_port;
+    uint32_t max_rtt_ms;
+    float max_loss;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        echo_host = echo_host_;
+        echo_port = echo_port_;
+        max_rtt_ms = max_rtt_ms_;
+        max_loss = max_loss_;
+    }
+
+    LinkHealth health = {};
+    health.ready = link.backend.IsReady();
+    health.healthy = health.ready;
+
+    if (!health.ready || echo_host.empty()) {
+        StopProbe(link);
+    } else {
+        if (link.udp && !link.udp->connected()) {
+            StopProbe(link);
+        }
+        if (!link.udp) {
+            link.udp.reset(link.backend.CreateUdp());
+            if (link.udp && link.udp->Connect(echo_host, echo_port)) {
+                link.probe = std::make_unique<UdpProbe>(*link.udp);
+                link.probe->Start(link.probe_interval_ms);
+            } else {
+                ESP_LOGW(TAG, "Failed to start probe on %s", link.backend.name());
+                link.udp.reset();
+                health.healthy = false;
+            }
+        }
+        if (link.probe) {
+            auto stats = link.probe->GetStats();
+            health.rtt_ms = stats.rtt_p50_us / 1000;
+            health.loss_rate = stats.loss_rate;
+            // 还没有任何回显时不认为健康
+            health.healthy = stats.received > 0 && health.rtt_ms <= max_rtt_ms && health.loss_rate <= max_loss;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (health.healthy != link.health.healthy || link.state_since_us == 0) {
+        link.state_since_us = now;
+    }
+    link.health = health;
+}
+
+void NetworkFailover::MonitorTask() {
+    while (!stopping_) {
+        int64_t now = esp_timer_get_time();
+        UpdateLink(primary_, now);
+        UpdateLink(backup_, now);
+
+        bool switched = false;
+        std::function<void(NetworkBackend& backend)> callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            int64_t primary_duration = now - primary_.state_since_us;
+            if (using_primary_) {
+                // 首选链路持续不健康，且备用链路可用
+                if (!primary_.health.healthy && primary_duration >= fail_hold_us_ && backup_.health.healthy) {
+                    using_primary_ = false;
+                    switched = true;
+                }
+            } else if (primary_.health.healthy && primary_duration >= recover_hold_us_) {
+                using_primary_ = true;
+                switched = true;
+            }
+            // 回调在锁外调用，允许其中再调用本类的方法
+            if (switched) {
+                callback = on_switch_callback_;
+            }
+        }
+
+        if (switched) {
+            auto& backend = Current();
+            ESP_LOGI(TAG, "Switched to %s (primary rtt=%lu ms loss=%.2f, backup rtt=%lu ms loss=%.2f)", backend.name(),
+                (unsigned long)primary_.health.rtt_ms, primary_.health.loss_rate,
+                (unsigned long)backup_.health.rtt_ms, backup_.health.loss_rate);
+            if (callback) {
+                callback(backend);
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(NETWORK_FAILOVER_CHECK_INTERVAL_MS));
+    }
+}
@@ -0,0 +1,363 @@
+#include "store_forward_mqtt.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cstdio>
+#include <ctime>
+#include <chrono>
+
+static const char *TAG = "StoreForwardMqtt";
+
+// 溢写文件记录格式：qos(1) expire_at(4) topic_len(2) payload_len(4) topic payload，小端
+#define SPILL_RECORD_HEADER_SIZE 11
+// 已补发到的文件位置保存在 <path>.pos（4 字节小端），重启后从该位置继续，不重复补发
+#define SPILL_OFFSET_SUFFIX ".pos"
+
+StoreForwardMqtt::StoreForwardMqtt(Mqtt* mqtt, size_t capacity) : mqtt_(mqtt), capacity_(capacity > 0 ? capacity : 1) {
+    // 传入的客户端可能已经连接，不会再收到 OnConnected
+    online_ = mqtt_->IsConnected();
+    mqtt_->OnConnected([this]() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            online_ = true;
+        }
+        cv_.notify_all();
+        if (on_connected_callback_) {
+            on_connected_callback_();
+        }
+    });
+    mqtt_->OnDisconnected([this]() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            online_ = false;
+        }
+        if (on_disconnected_callback_) {
+            on_disconnected_callback_();
+        }
+    });
+    mqtt_->OnMessageView([this](std::string_view topic, std::string_view payload) {
+        DispatchMessage(topic, payload);
+    });
+
+    drain_thread_ = std::thread(&StoreForwardMqtt::DrainTask, this);
+}
+
+StoreForwardMqtt::~StoreForwardMqtt() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (drain_thread_.joinable()) {
+        drain_thread_.join();
+    }
+    delete mqtt_;
+}
+
+void StoreForwardMqtt::SetSpillFile(const std::string& path, size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    spill_path_ = path;
+    spill_max_bytes_ = max_bytes;
+    spill_offset_path_ = path + SPILL_OFFSET_SUFFIX;
+    spill_read_offset_ = 0;
+    spill_size_ = 0;
+    if (spill_path_.empty()) {
+        return;
+    }
+
+    // 上次运行遗留的溢写数据在连接后继续补发
+    FILE* file = fopen(spill_path_.c_str(), "rb");
+    if (file != nullptr) {
+        fseek(file, 0, SEEK_END);
+        spill_size_ = ftell(file);
+        fclose(file);
+    }
+    file = fopen(spill_offset_path_.c_str(), "rb");
+    if (file != nullptr) {
+        uint8_t data[4];
+        if (fread(data, 1, sizeof(data), file) == sizeof(data)) {
+            uint32_t offset = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+            if (offset <= spill_size_) {
+                spill_read_offset_ = offset;
+            }
+        }
+        fclose(file);
+    }
+    if (spill_size_ > spill_read_offset_) {
+        ESP_LOGI(TAG, "Found %zu bytes of spilled messages in %s", spill_size_ - spill_read_offset_, spill_path_.c_str());
+    } else if (spill_size_ > 0) {
+        // 上次已经全部补发，只是没来得及删除
+        SpillCommit(spill_size_);
+    }
+}
+
+void StoreForwardMqtt::SetDrainInterval(int interval_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    drain_interval_ms_ = interval_ms;
+}
+
+void StoreForwardMqtt::SetDefaultExpiry(int expiry_seconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    default_expiry_seconds_ = expiry_seconds;
+}
+
+bool StoreForwardMqtt::Connect(const std::string& broker_address, int broker_port, const std::string& client_id, const std::string& username, const std::string& password) {
+    mqtt_->SetKeepAlive(keep_alive_seconds_);
+    mqtt_->SetCleanSession(clean_session_);
+    if (auto_reconnect_configured_) {
+        mqtt_->SetAutoReconnect(auto_reconnect_, reconnect_min_backoff_ms_, reconnect_max_backoff_ms_);
+    }
+    return mqtt_->Connect(broker_address, broker_port, client_id, username, password);
+}
+
+void StoreForwardMqtt::Disconnect() {
+    mqtt_->Disconnect();
+}
+
+bool StoreForwardMqtt::Publish(std::string_view topic, std::string_view payload, int qos) {
+    int expiry_seconds;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        expiry_seconds = default_expiry_seconds_;
+    }
+    return Publish(topic, payload, qos, expiry_seconds);
+}
+
+bool StoreForwardMqtt::Publish(std::string_view topic, std::string_view payload, int qos, int expiry_seconds) {
+    bool direct;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 队列中还有积压时直接发送会打乱顺序
+        direct = online_ && queue_.empty() && spill_size_ == spill_read_offset_;
+    }
+    if (direct && mqtt_->Publish(topic, payload, qos)) {
+        return true;
+    }
+
+    QueuedMessage message = {std::string(topic), std::string(payload), qos, 0};
+    if (expiry_seconds > 0) {
+        message.deadline_us = esp_timer_get_time() + expiry_seconds * 1000000LL;
+        time_t now = time(nullptr);
+        if (now >= STORE_FORWARD_MIN_VALID_TIME) {
+            message.expire_at = (uint32_t)now + expiry_seconds;
+        }
+    }
+    return Enqueue(std::move(message));
+}
+
+bool StoreForwardMqtt::Subscribe(const std::string& topic, int qos) {
+    return mqtt_->Subscribe(topic, qos);
+}
+
+bool StoreForwardMqtt::SubscribeMultiple(std::vector<MqttSubscription>& subscriptions) {
+    return mqtt_->SubscribeMultiple(subscriptions);
+}
+
+bool StoreForwardMqtt::Unsubscribe(const std::string& topic) {
+    RemoveMessageHandler(topic);
+    return mqtt_->Unsubscribe(topic);
+}
+
+bool StoreForwardMqtt::IsConnected() {
+    return mqtt_->IsConnected();
+}
+
+size_t StoreForwardMqtt::GetQueuedCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+size_t StoreForwardMqtt::GetDroppedCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_count_;
+}
+
+bool StoreForwardMqtt::Enqueue(QueuedMessage&& message) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool spilling = spill_size_ > spill_read_offset_;
+        if (queue_.size() >= capacity_ || spilling) {
+            // 内存队列已满，或文件中有更早的消息：追加到文件以保持顺序
+            if (!spill_path_.empty() && SpillAppend(message)) {
+                cv_.notify_all();
+                return true;
+            }
+            if (spilling) {
+                dropped_count_++;
+                ESP_LOGW(TAG, "Spill file full, dropping message to %s", message.topic.c_str());
+                return false;
+            }
+            queue_.pop_front();
+            dropped_count_++;
+        }
+        queue_.push_back(std::move(message));
+    }
+    cv_.notify_all();
+    return true;
+}
+
+bool StoreForwardMqtt::SpillAppend(const QueuedMessage& message) {
+    size_t record_size = SPILL_RECORD_HEADER_SIZE + message.topic.size() + message.payload.size();
+    if (spill_size_ + record_size > spill_max_bytes_) {
+        return false;
+    }
+
+    FILE* file = fopen(spill_path_.c_str(), "ab");
+    if (file == nullptr) {
+        ESP_LOGE(TAG, "Failed to open spill file %s", spill_path_.c_str());
+        return false;
+    }
+    uint8_t header[SPILL_RECORD_HEADER_SIZE];
+    uint16_t topic_length = message.topic.size();
+    uint32_t payload_length = message.payload.size();
+    header[0] = message.qos;
+    for (int i = 0; i < 4; i++) {
+        header[1 + i] = (message.expire_at >> (8 * i)) & 0xFF;
+    }
+    header[5] = topic_length & 0xFF;
+    header[6] = topic_length >> 8;
+    for (int i = 0; i < 4; i++) {
+        header[7 + i] = (payload_length >> (8 * i)) & 0xFF;
+    }
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header)
+        && fwrite(message.topic.data(), 1, topic_length, file) == topic_length
+        && fwrite(message.payload.data(), 1, payload_length, file) == payload_length;
+    fclose(file);
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to write spill file %s", spill_path_.c_str());
+        return false;
+    }
+    spill_size_ += record_size;
+    return true;
+}
+
+void StoreForwardMqtt::SpillLoad() {
+    // 调用者持有 mutex_，且内存队列为空
+    FILE* file = fopen(spill_path_.c_str(), "rb");
+    if (file == nullptr || fseek(file, spill_read_offset_, SEEK_SET) != 0) {
+        ESP_LOGE(TAG, "Failed to read spill file %s", spill_path_.c_str());
+        if (file != nullptr) {
+            fclose(file);
+        }
+        spill_size_ = spill_read_offset_ = 0;
+        return;
+    }
+
+    while (queue_.size() < capacity_ && spill_read_offset_ < spill_size_) {
+        uint8_t header[SPILL_RECORD_HEADER_SIZE];
+        if (fread(header, 1, sizeof(header), file) != sizeof(header)) {
+            break;
+        }
+        QueuedMessage message;
+        message.qos = header[0];
+        message.expire_at = header[1] | (header[2] << 8) | (header[3] << 16) | ((uint32_t)header[4] << 24);
+        uint16_t topic_length = header[5] | (header[6] << 8);
+        uint32_t payload_length = header[7] | (header[8] << 8) | (header[9] << 16) | ((uint32_t)header[10] << 24);
+        message.topic.resize(topic_length);
+        message.payload.resize(payload_length);
+        if (fread(message.topic.data(), 1, topic_length, file) != topic_length
+            || fread(message.payload.data(), 1, payload_length, file) != payload_length) {
+            break;
+        }
+        spill_read_offset_ += SPILL_RECORD_HEADER_SIZE + topic_length + payload_length;
+        message.spill_end = spill_read_offset_;
+        if (!IsExpired(message)) {
+            queue_.push_back(std::move(message));
+        }
+    }
+    fclose(file);
+
+    if (queue_.empty()) {
+        if (spill_read_offset_ < spill_size_) {
+            // 读不出完整记录，文件已损坏
+            ESP_LOGW(TAG, "Spill file %s is corrupted, discarding", spill_path_.c_str());
+            spill_read_offset_ = spill_size_;
+        }
+        // 这一批全部过期，直接记录进度
+        SpillCommit(spill_read_offset_);
+    }
+}
+
+void StoreForwardMqtt::SpillCommit(uint32_t offset) {
+    // 调用者持有 mutex_。文件全部读完且没有待发送的溢写消息时删除文件，从头开始
+    if (spill_read_offset_ >= spill_size_) {
+        remove(spill_path_.c_str());
+        remove(spill_offset_path_.c_str());
+        spill_size_ = spill_read_offset_ = 0;
+        return;
+    }
+
+    // 每批消息发送完才记录一次，减少 Flash 写入；掉电时最多重发一批
+    FILE* file = fopen(spill_offset_path_.c_str(), "wb");
+    if (file == nullptr) {
+        ESP_LOGE(TAG, "Failed to open %s", spill_offset_path_.c_str());
+        return;
+    }
+    uint8_t data[4];
+    for (int i = 0; i < 4; i++) {
+        data[i] = (offset >> (8 * i)) & 0xFF;
+    }
+    if (fwrite(data, 1, sizeof(data), file) != sizeof(data)) {
+        ESP_LOGE(TAG, "Failed to write %s", spill_offset_path_.c_str());
+    }
+    fclose(file);
+}
+
+void StoreForwardMqtt::OnMessageDone(const QueuedMessage& message) {
+    // 溢写消息总是位于队首，队首不再是溢写消息时这一批已经发送完
+    if (message.spill_end == 0) {
+        return;
+    }
+    if (queue_.empty() || queue_.front().spill_end == 0) {
+        SpillCommit(message.spill_end);
+    }
+}
+
+bool StoreForwardMqtt::IsExpired(const QueuedMessage& message) const {
+    if (message.deadline_us != 0) {
+        return esp_timer_get_time() >= message.deadline_us;
+    }
+    if (message.expire_at == 0) {
+        return false;
+    }
+    // 重启后时间还没同步时先保留，等同步后再判断
+    time_t now = time(nullptr);
+    return now >= STORE_FORWARD_MIN_VALID_TIME && (uint32_t)now >= message.expire_at;
+}
+
+void StoreForwardMqtt::DrainTask() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (queue_.empty() && spill_size_ > spill_read_offset_) {
+            SpillLoad();
+        }
+        if (!online_ || queue_.empty()) {
+            cv_.wait(lock);
+            continue;
+        }
+
+        QueuedMessage message = std::move(queue_.front());
+        queue_.pop_front();
+        if (IsExpired(message)) {
+            dropped_count_++;
+            OnMessageDone(message);
+            continue;
+        }
+
+        lock.unlock();
+        bool ok = mqtt_->Publish(message.topic, message.payload, message.qos);
+        lock.lock();
+
+        if (!ok) {
+            // 发送失败，放回队首等待下次连接
+            queue_.push_front(std::move(message));
+            if (queue_.size() > capacity_) {
+                queue_.pop_back();
+                dropped_count_++;
+            }
+            cv_.wait_for(lock, std::chrono::milliseconds(1000), [this] { return stopping_; });
+            continue;
+        }
+        OnMessageDone(message);
+        cv_.wait_for(lock, std::chrono::milliseconds(drain_interval_ms_), [this] { return stopping_; });
+    }
+}
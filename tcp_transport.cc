@@ -1,10 +1,15 @@
 #include "tcp_transport.h"
+#include "dns_cache.h"
 #include <esp_log.h>
 #include <unistd.h>
 #include <cstring>
+#include <vector>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <netinet/tcp.h>
 #define TAG "TcpTransport"
 
 TcpTransport::TcpTransport() : fd_(-1) {}
@@ -15,34 +20,124 @@ TcpTransport::~TcpTransport() {
     }
 }
 
+void TcpTransport::SetConnectTimeout(int timeout_ms) {
+    connect_timeout_ms_ = timeout_ms;
+}
+
+void TcpTransport::SetNoDelay(bool enable) {
+    no_delay_ = enable;
+}
+
+void TcpTransport::SetKeepAlive(bool enable, int idle_seconds, int interval_seconds, int count) {
+    keep_alive_ = enable;
+    keep_alive_idle_ = idle_seconds;
+    keep_alive_interval_ = interval_seconds;
+    keep_alive_count_ = count;
+}
+
+void TcpTransport::SetBufferSizes(int send_buffer_size, int receive_buffer_size) {
+    send_buffer_size_ = send_buffer_size;
+    receive_buffer_size_ = receive_buffer_size;
+}
+
 bool TcpTransport::Connect(const char* host, int port) {
-    struct sockaddr_in server_addr;
-    bzero(&server_addr, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(port);
-    // host is domain
-    struct hostent *server = gethostbyname(host);
-    if (server == NULL) {
-        ESP_LOGE(TAG, "Failed to get host by name");
-        return false;
-    }
-    memcpy(&server_addr.sin_addr, server->h_addr, server->h_length);
+    Disconnect();
 
-    fd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (fd_ < 0) {
-        ESP_LOGE(TAG, "Failed to create socket");
+    std::vector<struct sockaddr_storage> addrs;
+    if (!DnsCache::GetInstance().Resolve(host, addrs)) {
+        ESP_LOGE(TAG, "Failed to resolve %s", host);
         return false;
     }
 
-    int ret = connect(fd_, (struct sockaddr*)&server_addr, sizeof(server_addr));
-    if (ret < 0) {
-        ESP_LOGE(TAG, "Failed to connect to %s:%d", host, port);
+    // 依次尝试每个地址（IPv4 和 IPv6），直到有一个连上
+    for (auto& addr : addrs) {
+        size_t addr_len;
+        if (addr.ss_family == AF_INET6) {
+            ((struct sockaddr_in6*)&addr)->sin6_port = htons(port);
+            addr_len = sizeof(struct sockaddr_in6);
+        } else {
+            ((struct sockaddr_in*)&addr)->sin_port = htons(port);
+            addr_len = sizeof(struct sockaddr_in);
+        }
+        fd_ = socket(addr.ss_family, SOCK_STREAM, 0);
+        if (fd_ < 0) {
+            ESP_LOGE(TAG, "Failed to create socket");
+            continue;
+        }
+        ApplySocketOptions();
+        if (ConnectWithTimeout((struct sockaddr*)&addr, addr_len)) {
+            connected_ = true;
+            break;
+        }
         close(fd_);
         fd_ = -1;
+    }
+
+    if (!connected_) {
+        ESP_LOGE(TAG, "Failed to connect to %s:%d", host, port);
+        // 地址可能已经变化，下次重新解析
+        DnsCache::GetInstance().Invalidate(host);
         return false;
     }
+    return true;
+}
+
+void TcpTransport::ApplySocketOptions() {
+    int value = no_delay_ ? 1 : 0;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+    if (keep_alive_) {
+        value = 1;
+        setsockopt(fd_, SOL_SOCKET, SO_KEEPALIVE, &value, sizeof(value));
+        setsockopt(fd_, IPPROTO_TCP, TCP_KEEPIDLE, &keep_alive_idle_, sizeof(keep_alive_idle_));
+        setsockopt(fd_, IPPROTO_TCP, TCP_KEEPINTVL, &keep_alive_interval_, sizeof(keep_alive_interval_));
+        setsockopt(fd_, IPPROTO_TCP, TCP_KEEPCNT, &keep_alive_count_, sizeof(keep_alive_count_));
+    }
+    if (send_buffer_size_ > 0) {
+        setsockopt(fd_, SOL_SOCKET, SO_SNDBUF, &send_buffer_size_, sizeof(send_buffer_size_));
+    }
+    if (receive_buffer_size_ > 0) {
+        setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &receive_buffer_size_, sizeof(receive_buffer_size_));
+    }
+}
 
-    connected_ = true;
+bool TcpTransport::ConnectWithTimeout(const struct sockaddr* addr, size_t addr_len) {
+    // 非阻塞 connect，用 select 等待完成或超时
+    int flags = fcntl(fd_, F_GETFL, 0);
+    fcntl(fd_, F_SETFL, flags | O_NONBLOCK);
+
+    int ret = connect(fd_, addr, addr_len);
+    if (ret < 0 && errno != EINPROGRESS) {
+        ESP_LOGE(TAG, "Connect failed: errno=%d", errno);
+        return false;
+    }
+    if (ret < 0) {
+        fd_set write_fds;
+        FD_ZERO(&write_fds);
+        FD_SET(fd_, &write_fds);
+        struct timeval timeout = {
+            .tv_sec = connect_timeout_ms_ / 1000,
+            .tv_usec = (connect_timeout_ms_ % 1000) * 1000,
+        };
+        ret = select(fd_ + 1, NULL, &write_fds, NULL, &timeout);
+        if (ret == 0) {
+            ESP_LOGE(TAG, "Connect timed out after %d ms", connect_timeout_ms_);
+            return false;
+        }
+        if (ret < 0) {
+            ESP_LOGE(TAG, "Select failed: errno=%d", errno);
+            return false;
+        }
+        int error = 0;
+        socklen_t error_len = sizeof(error);
+        getsockopt(fd_, SOL_SOCKET, SO_ERROR, &error, &error_len);
+        if (error != 0) {
+            ESP_LOGE(TAG, "Connect failed: errno=%d", error);
+            return false;
+        }
+    }
+
+    // 后续 Send/Receive 仍按阻塞方式工作
+    fcntl(fd_, F_SETFL, flags);
     return true;
 }
 
@@ -72,6 +167,3 @@ int TcpTransport::Receive(char* buffer, size_t bufferSize) {
     }
     return ret;
 }
-
-
-
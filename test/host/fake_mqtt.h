@@ -0,0 +1,81 @@
+#ifndef HOST_FAKE_MQTT_H
+#define HOST_FAKE_MQTT_H
+
+#include "mqtt.h"
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+// 记录发布内容的 Mqtt 替身，publish_limit 之后的发布返回失败
+class FakeMqtt : public Mqtt {
+public:
+    struct Message {
+        std::string topic;
+        std::string payload;
+        int qos;
+    };
+
+    bool Connect(const std::string& broker_address, int broker_port, const std::string& client_id, const std::string& username, const std::string& password) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            connected_ = true;
+        }
+        if (on_connected_callback_) {
+            on_connected_callback_();
+        }
+        return true;
+    }
+
+    void Disconnect() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            connected_ = false;
+        }
+        if (on_disconnected_callback_) {
+            on_disconnected_callback_();
+        }
+    }
+
+    bool Publish(std::string_view topic, std::string_view payload, int qos = 0) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!connected_ || published_.size() >= publish_limit_) {
+            return false;
+        }
+        published_.push_back({std::string(topic), std::string(payload), qos});
+        return true;
+    }
+
+    bool Subscribe(const std::string& topic, int qos = 0) override { return true; }
+    using Mqtt::Subscribe;
+    bool Unsubscribe(const std::string& topic) override { return true; }
+
+    bool IsConnected() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return connected_;
+    }
+
+    // 不触发回调，模拟交给包装类之前就已连接的客户端
+    void SetConnected(bool connected) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connected_ = connected;
+    }
+
+    void SetPublishLimit(size_t limit) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        publish_limit_ = limit;
+    }
+
+    std::vector<Message> GetPublished() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return published_;
+    }
+
+private:
+    std::mutex mutex_;
+    bool connected_ = false;
+    size_t publish_limit_ = SIZE_MAX;
+    std::vector<Message> published_;
+};
+
+#endif // HOST_FAKE_MQTT_H
@@ -0,0 +1,10 @@
+#ifndef HOST_STUB_ESP_RANDOM_H
+#define HOST_STUB_ESP_RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+
+uint32_t esp_random();
+void esp_fill_random(void* buffer, size_t length);
+
+#endif // HOST_STUB_ESP_RANDOM_H
@@ -0,0 +1,12 @@
+#ifndef HOST_STUB_ESP_TIMER_H
+#define HOST_STUB_ESP_TIMER_H
+
+#include <cstdint>
+
+// 开机以来的微秒数，主机上用 steady_clock
+int64_t esp_timer_get_time();
+
+// 仅主机测试使用：固定 esp_timer_get_time 的返回值，传负数恢复真实时间
+void host_timer_set_time(int64_t time_us);
+
+#endif // HOST_STUB_ESP_TIMER_H
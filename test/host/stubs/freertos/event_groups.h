@@ -0,0 +1,25 @@
+#ifndef HOST_STUB_FREERTOS_EVENT_GROUPS_H
+#define HOST_STUB_FREERTOS_EVENT_GROUPS_H
+
+#include "FreeRTOS.h"
+
+typedef uint32_t EventBits_t;
+typedef struct HostEventGroup* EventGroupHandle_t;
+
+#define BIT0 (1u << 0)
+#define BIT1 (1u << 1)
+#define BIT2 (1u << 2)
+#define BIT3 (1u << 3)
+#define BIT4 (1u << 4)
+#define BIT5 (1u << 5)
+#define BIT6 (1u << 6)
+#define BIT7 (1u << 7)
+
+EventGroupHandle_t xEventGroupCreate();
+void vEventGroupDelete(EventGroupHandle_t event_group);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t event_group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t event_group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t event_group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t event_group, EventBits_t bits, BaseType_t clear_on_exit, BaseType_t wait_for_all, TickType_t ticks);
+
+#endif // HOST_STUB_FREERTOS_EVENT_GROUPS_H
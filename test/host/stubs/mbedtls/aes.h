@@ -0,0 +1,19 @@
+#ifndef HOST_STUB_MBEDTLS_AES_H
+#define HOST_STUB_MBEDTLS_AES_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 主机上没有 mbedtls，这里是只支持加密方向的软件 AES，接口与 mbedtls 一致
+typedef struct {
+    int rounds;
+    uint8_t round_keys[240];
+} mbedtls_aes_context;
+
+void mbedtls_aes_init(mbedtls_aes_context* ctx);
+void mbedtls_aes_free(mbedtls_aes_context* ctx);
+int mbedtls_aes_setkey_enc(mbedtls_aes_context* ctx, const unsigned char* key, unsigned int keybits);
+int mbedtls_aes_crypt_ctr(mbedtls_aes_context* ctx, size_t length, size_t* nc_off, unsigned char nonce_counter[16],
+    unsigned char stream_block[16], const unsigned char* input, unsigned char* output);
+
+#endif // HOST_STUB_MBEDTLS_AES_H
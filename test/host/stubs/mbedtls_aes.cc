@@ -0,0 +1,124 @@
+#include <mbedtls/aes.h>
+
+#include <cstring>
+
+static uint8_t sbox[256];
+
+static uint8_t Multiply(uint8_t a, uint8_t b) {
+    uint8_t result = 0;
+    while (b) {
+        if (b & 1) {
+            result ^= a;
+        }
+        a = (a << 1) ^ ((a & 0x80) ? 0x1B : 0);
+        b >>= 1;
+    }
+    return result;
+}
+
+// S 盒 = GF(2^8) 上的乘法逆元再做仿射变换（FIPS-197 5.1.1）
+static void InitSbox() {
+    if (sbox[0] == 0x63) {
+        return;
+    }
+    for (int i = 0; i < 256; i++) {
+        uint8_t inverse = 0;
+        for (int j = 1; i != 0 && j < 256; j++) {
+            if (Multiply(i, j) == 1) {
+                inverse = j;
+                break;
+            }
+        }
+        uint8_t value = inverse;
+        for (int shift = 1; shift < 5; shift++) {
+            value ^= (uint8_t)((inverse << shift) | (inverse >> (8 - shift)));
+        }
+        sbox[i] = value ^ 0x63;
+    }
+}
+
+void mbedtls_aes_init(mbedtls_aes_context* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void mbedtls_aes_free(mbedtls_aes_context* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int mbedtls_aes_setkey_enc(mbedtls_aes_context* ctx, const unsigned char* key, unsigned int keybits) {
+    if (keybits != 128 && keybits != 192 && keybits != 256) {
+        return -0x0020;
+    }
+    InitSbox();
+    int key_words = keybits / 32;
+    ctx->rounds = key_words + 6;
+    int total_words = 4 * (ctx->rounds + 1);
+    memcpy(ctx->round_keys, key, key_words * 4);
+    uint8_t rcon = 1;
+    for (int i = key_words; i < total_words; i++) {
+        uint8_t temp[4];
+        memcpy(temp, ctx->round_keys + (i - 1) * 4, 4);
+        if (i % key_words == 0) {
+            uint8_t first = temp[0];
+            temp[0] = sbox[temp[1]] ^ rcon;
+            temp[1] = sbox[temp[2]];
+            temp[2] = sbox[temp[3]];
+            temp[3] = sbox[first];
+            rcon = Multiply(rcon, 2);
+        } else if (key_words > 6 && i % key_words == 4) {
+            for (auto& byte : temp) {
+                byte = sbox[byte];
+            }
+        }
+        for (int j = 0; j < 4; j++) {
+            ctx->round_keys[i * 4 + j] = ctx->round_keys[(i - key_words) * 4 + j] ^ temp[j];
+        }
+    }
+    return 0;
+}
+
+static void EncryptBlock(const mbedtls_aes_context* ctx, const uint8_t input[16], uint8_t output[16]) {
+    uint8_t state[16];
+    for (int i = 0; i < 16; i++) {
+        state[i] = input[i] ^ ctx->round_keys[i];
+    }
+    for (int round = 1; round <= ctx->rounds; round++) {
+        uint8_t shifted[16];
+        // SubBytes + ShiftRows，状态按列存放：state[列 * 4 + 行]
+        for (int column = 0; column < 4; column++) {
+            for (int row = 0; row < 4; row++) {
+                shifted[column * 4 + row] = sbox[state[((column + row) % 4) * 4 + row]];
+            }
+        }
+        if (round != ctx->rounds) {
+            for (int column = 0; column < 4; column++) {
+                uint8_t* c = shifted + column * 4;
+                uint8_t a0 = c[0], a1 = c[1], a2 = c[2], a3 = c[3];
+                c[0] = Multiply(a0, 2) ^ Multiply(a1, 3) ^ a2 ^ a3;
+                c[1] = a0 ^ Multiply(a1, 2) ^ Multiply(a2, 3) ^ a3;
+                c[2] = a0 ^ a1 ^ Multiply(a2, 2) ^ Multiply(a3, 3);
+                c[3] = Multiply(a0, 3) ^ a1 ^ a2 ^ Multiply(a3, 2);
+            }
+        }
+        for (int i = 0; i < 16; i++) {
+            state[i] = shifted[i] ^ ctx->round_keys[round * 16 + i];
+        }
+    }
+    memcpy(output, state, 16);
+}
+
+int mbedtls_aes_crypt_ctr(mbedtls_aes_context* ctx, size_t length, size_t* nc_off, unsigned char nonce_counter[16],
+    unsigned char stream_block[16], const unsigned char* input, unsigned char* output) {
+    size_t offset = *nc_off;
+    for (size_t i = 0; i < length; i++) {
+        if (offset == 0) {
+            EncryptBlock(ctx, nonce_counter, stream_block);
+            for (int j = 15; j >= 0 && ++nonce_counter[j] == 0; j--) {
+            }
+        }
+        output[i] = input[i] ^ stream_block[offset];
+        offset = (offset + 1) % 16;
+    }
+    *nc_off = offset;
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <esp_timer.h>
+#include <esp_random.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/event_groups.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <thread>
+
+static std::atomic<int64_t> fixed_time_us{-1};
+
+void host_timer_set_time(int64_t time_us) {
+    fixed_time_us = time_us;
+}
+
+int64_t esp_timer_get_time() {
+    int64_t fixed = fixed_time_us;
+    if (fixed >= 0) {
+        return fixed;
+    }
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint32_t esp_random() {
+    static std::mt19937 generator(std::random_device{}());
+    return generator();
+}
+
+void esp_fill_random(void* buffer, size_t length) {
+    auto data = static_cast<uint8_t*>(buffer);
+    for (size_t i = 0; i < length; i++) {
+        data[i] = esp_random() & 0xFF;
+    }
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stack_size, void* arg, UBaseType_t priority, TaskHandle_t* handle) {
+    // 句柄只用来判断任务是否存在，给每个任务一个不同的非空值
+    static std::atomic<uintptr_t> next_handle{1};
+    if (handle != nullptr) {
+        *handle = reinterpret_cast<TaskHandle_t>(next_handle++);
+    }
+    std::thread(function, arg).detach();
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t handle) {
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+TickType_t xTaskGetTickCount() {
+    return esp_timer_get_time() / 1000 / portTICK_PERIOD_MS;
+}
+
+struct HostEventGroup {
+    std::mutex mutex;
+    std::condition_variable cv;
+    EventBits_t bits = 0;
+};
+
+EventGroupHandle_t xEventGroupCreate() {
+    return new HostEventGroup();
+}
+
+void vEventGroupDelete(EventGroupHandle_t event_group) {
+    delete event_group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t event_group, EventBits_t bits) {
+    std::lock_guard<std::mutex> lock(event_group->mutex);
+    event_group->bits |= bits;
+    event_group->cv.notify_all();
+    return event_group->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t event_group, EventBits_t bits) {
+    std::lock_guard<std::mutex> lock(event_group->mutex);
+    EventBits_t previous = event_group->bits;
+    event_group->bits &= ~bits;
+    return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t event_group) {
+    std::lock_guard<std::mutex> lock(event_group->mutex);
+    return event_group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t event_group, EventBits_t bits, BaseType_t clear_on_exit, BaseType_t wait_for_all, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(event_group->mutex);
+    auto ready = [&] {
+        EventBits_t matched = event_group->bits & bits;
+        return wait_for_all ? matched == bits : matched != 0;
+    };
+    if (ticks == portMAX_DELAY) {
+        event_group->cv.wait(lock, ready);
+    } else {
+        event_group->cv.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), ready);
+    }
+    EventBits_t result = event_group->bits;
+    if (clear_on_exit && ready()) {
+        event_group->bits &= ~bits;
+    }
+    return result;
+}
@@ -0,0 +1,80 @@
+#include "datagram_pool.h"
+#include "udp.h"
+#include "test_util.h"
+
+#include <cstring>
+
+static void TestAcquireAndExhaust() {
+    auto pool = DatagramPool::Create(2, 8);
+    CHECK_EQ(pool->buffer_size(), 8u);
+    auto first = pool->Acquire();
+    auto second = pool->Acquire();
+    CHECK(first && second);
+    CHECK(first.data() != second.data());
+    CHECK_EQ(first.capacity(), 8u);
+    CHECK(!pool->Acquire());
+    CHECK_EQ(pool->exhausted_count(), 1u);
+    CHECK_EQ(pool->available(), 0u);
+}
+
+static void TestRefCountReturnsOnLastRelease() {
+    auto pool = DatagramPool::Create(2, 8);
+    auto buffer = pool->Acquire();
+    memcpy(buffer.data(), "hi", 2);
+    buffer.set_size(2);
+
+    auto copy = buffer;
+    CHECK_EQ(copy.size(), 2u);
+    CHECK(memcmp(copy.data(), "hi", 2) == 0);
+    buffer.Release();
+    CHECK(!buffer);
+    CHECK_EQ(pool->available(), 1u);
+    copy.Release();
+    CHECK_EQ(pool->available(), 2u);
+
+    auto moved_from = pool->Acquire();
+    DatagramBuffer moved = std::move(moved_from);
+    CHECK(!moved_from);
+    CHECK(moved);
+    moved = DatagramBuffer();
+    CHECK_EQ(pool->available(), 2u);
+}
+
+static void TestBufferOutlivesPoolOwner() {
+    auto pool = DatagramPool::Create(1, 8);
+    auto buffer = pool->Acquire();
+    // 句柄持有池的引用，池的其它所有者释放后缓冲区仍然有效
+    pool.reset();
+    memcpy(buffer.data(), "ok", 2);
+    buffer.Release();
+}
+
+class TestUdp : public Udp {
+public:
+    bool Connect(const std::string& host, int port) override { return true; }
+    void Disconnect() override {}
+    int Send(const std::string& data) override { return data.size(); }
+    DatagramPool* pool() const { return buffer_pool_.get(); }
+};
+
+static void TestSetBufferPoolNullRestoresDefault() {
+    TestUdp udp;
+    udp.OnMessageBuffer([](DatagramBuffer buffer) {});
+    CHECK(udp.pool() != nullptr);
+    udp.SetBufferPool(nullptr);
+    CHECK(udp.pool() != nullptr);
+    CHECK_EQ(udp.pool()->buffer_size(), (size_t)DATAGRAM_POOL_DEFAULT_BUFFER_SIZE);
+
+    auto custom = DatagramPool::Create(1, 64);
+    udp.SetBufferPool(custom);
+    CHECK(udp.pool() == custom.get());
+}
+
+int main() {
+    TestAcquireAndExhaust();
+    TestRefCountReturnsOnLastRelease();
+    TestBufferOutlivesPoolOwner();
+    TestSetBufferPoolNullRestoresDefault();
+    printf("datagram_pool: OK\n");
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include "dns_cache.h"
+#include "test_util.h"
+
+#include <esp_timer.h>
+#include <arpa/inet.h>
+#include <thread>
+#include <vector>
+
+static void TestLiteralsBypassCache() {
+    auto& cache = DnsCache::GetInstance();
+    cache.Clear();
+    auto before = cache.GetStats();
+
+    std::vector<struct sockaddr_storage> addrs;
+    CHECK(cache.Resolve("192.0.2.1", addrs));
+    CHECK_EQ(addrs.size(), 1u);
+    CHECK_EQ(addrs[0].ss_family, AF_INET);
+    CHECK(cache.Resolve("2001:db8::1", addrs));
+    CHECK_EQ(addrs.size(), 1u);
+    CHECK_EQ(addrs[0].ss_family, AF_INET6);
+
+    struct in_addr addr;
+    CHECK(cache.Resolve("192.0.2.1", addr));
+    CHECK_EQ(addr.s_addr, inet_addr("192.0.2.1"));
+    // 只有 IPv6 地址时 IPv4 版本失败
+    CHECK(!cache.Resolve("2001:db8::1", addr));
+
+    auto after = cache.GetStats();
+    CHECK_EQ(after.hits, before.hits);
+    CHECK_EQ(after.misses, before.misses);
+}
+
+static void TestHitAfterMiss() {
+    auto& cache = DnsCache::GetInstance();
+    cache.Clear();
+    auto before = cache.GetStats();
+
+    std::vector<struct sockaddr_storage> addrs;
+    CHECK(cache.Resolve("localhost", addrs));
+    CHECK(!addrs.empty());
+    CHECK(cache.Resolve("localhost", addrs));
+
+    auto after = cache.GetStats();
+    CHECK_EQ(after.misses, before.misses + 1);
+    CHECK_EQ(after.hits, before.hits + 1);
+}
+
+static void TestInvalidateIsRateLimited() {
+    auto& cache = DnsCache::GetInstance();
+    cache.Clear();
+    host_timer_set_time(1000000000LL);
+    std::vector<struct sockaddr_storage> addrs;
+    CHECK(cache.Resolve("localhost", addrs));
+    auto before = cache.GetStats();
+
+    // 刚解析的地址不会因为一次连接失败被丢弃
+    cache.Invalidate("localhost");
+    CHECK(cache.Resolve("localhost", addrs));
+    auto after = cache.GetStats();
+    CHECK_EQ(after.misses, before.misses);
+    CHECK_EQ(after.hits, before.hits + 1);
+
+    host_timer_set_time(1000000000LL + (DNS_CACHE_MIN_INVALIDATE_INTERVAL_SECONDS + 1) * 1000000LL);
+    cache.Invalidate("localhost");
+    CHECK(cache.Resolve("localhost", addrs));
+    after = cache.GetStats();
+    CHECK_EQ(after.misses, before.misses + 1);
+    host_timer_set_time(-1);
+}
+
+static void TestNegativeCaching() {
+    auto& cache = DnsCache::GetInstance();
+    cache.Clear();
+    auto before = cache.GetStats();
+
+    std::vector<struct sockaddr_storage> addrs;
+    CHECK(!cache.Resolve("nonexistent.invalid", addrs));
+    CHECK(!cache.Resolve("nonexistent.invalid", addrs));
+
+    auto after = cache.GetStats();
+    CHECK_EQ(after.misses, before.misses + 1);
+    CHECK_EQ(after.negative_hits, before.negative_hits + 1);
+}
+
+static void TestConcurrentResolvesCoalesce() {
+    auto& cache = DnsCache::GetInstance();
+    cache.Clear();
+    auto before = cache.GetStats();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&cache] {
+            std::vector<struct sockaddr_storage> addrs;
+            CHECK(cache.Resolve("localhost", addrs));
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto after = cache.GetStats();
+    CHECK_EQ(after.misses, before.misses + 1);
+    CHECK_EQ(after.hits, before.hits + 3);
+}
+
+int main() {
+    TestLiteralsBypassCache();
+    TestHitAfterMiss();
+    TestInvalidateIsRateLimited();
+    TestNegativeCaching();
+    TestConcurrentResolvesCoalesce();
+    printf("dns_cache: OK\n");
+    return 0;
+}
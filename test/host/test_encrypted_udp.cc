@@ -0,0 +1,183 @@
+#include "encrypted_udp.h"
+#include "test_util.h"
+
+#include <mbedtls/aes.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static std::string FromHex(const char* hex) {
+    std::string bytes;
+    for (size_t i = 0; hex[i] && hex[i + 1]; i += 2) {
+        bytes.push_back((char)std::stoi(std::string(hex + i, 2), nullptr, 16));
+    }
+    return bytes;
+}
+
+// 两个 LoopbackUdp 互为对端，Send 直接交给对端的接收回调
+class LoopbackUdp : public Udp {
+public:
+    LoopbackUdp* peer = nullptr;
+    std::vector<std::string> sent;
+
+    bool Connect(const std::string& host, int port) override {
+        connected_ = true;
+        return true;
+    }
+    void Disconnect() override { connected_ = false; }
+    int Send(const std::string& data) override {
+        sent.push_back(data);
+        if (peer != nullptr) {
+            peer->Deliver(data);
+        }
+        return data.size();
+    }
+    void Deliver(const std::string& data) {
+        if (buffer_callback_) {
+            auto buffer = buffer_pool_->Acquire();
+            CHECK(buffer);
+            memcpy(buffer.data(), data.data(), data.size());
+            buffer.set_size(data.size());
+            buffer_callback_(std::move(buffer));
+        } else if (message_callback_) {
+            message_callback_(data);
+        }
+    }
+};
+
+static const std::string key = FromHex("2b7e151628aed2a6abf7158809cf4f3c");
+static const std::string salt = "saltsalt";
+
+static void TestHostAesMatchesSp80038a() {
+    // NIST SP 800-38A F.5.1 CTR-AES128.Encrypt
+    mbedtls_aes_context aes;
+    mbedtls_aes_init(&aes);
+    CHECK_EQ(mbedtls_aes_setkey_enc(&aes, (const unsigned char*)key.data(), 128), 0);
+    auto counter = FromHex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+    auto plaintext = FromHex("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51");
+    std::string ciphertext(plaintext.size(), 0);
+    unsigned char stream_block[16];
+    size_t offset = 0;
+    mbedtls_aes_crypt_ctr(&aes, plaintext.size(), &offset, (unsigned char*)counter.data(), stream_block,
+        (const unsigned char*)plaintext.data(), (unsigned char*)ciphertext.data());
+    CHECK(ciphertext == FromHex("874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"));
+    mbedtls_aes_free(&aes);
+}
+
+static void TestWireFormat() {
+    auto udp = new LoopbackUdp();
+    EncryptedUdp client(udp, key, salt);
+    CHECK(client.Connect("host", 1));
+    std::string payload = "hello, encrypted world";
+    CHECK_EQ(client.Send(payload), (int)payload.size());
+    CHECK_EQ(client.Send(payload), (int)payload.size());
+    CHECK_EQ(udp->sent.size(), 2u);
+
+    auto& first = udp->sent[0];
+    auto& second = udp->sent[1];
+    CHECK_EQ(first.size(), ENCRYPTED_UDP_HEADER_SIZE + payload.size());
+    // 同一会话，序号从 0 开始递增，大端
+    CHECK(memcmp(first.data(), second.data(), 4) == 0);
+    CHECK(memcmp(first.data() + 4, "\0\0\0\0", 4) == 0);
+    CHECK(memcmp(second.data() + 4, "\0\0\0\1", 4) == 0);
+    // 相同明文每个数据报的密文都不同
+    CHECK(first.substr(ENCRYPTED_UDP_HEADER_SIZE) != payload);
+    CHECK(first.substr(ENCRYPTED_UDP_HEADER_SIZE) != second.substr(ENCRYPTED_UDP_HEADER_SIZE));
+
+    // 按文档中的计数器块布局独立计算密文
+    uint8_t counter[16] = {};
+    memcpy(counter, salt.data(), ENCRYPTED_UDP_SALT_SIZE);
+    for (int i = 0; i < 4; i++) {
+        counter[i] ^= first[i];
+    }
+    memcpy(counter + 8, first.data() + 4, 4);
+    counter[12] = ENCRYPTED_UDP_DIRECTION_UPLINK;
+    mbedtls_aes_context aes;
+    mbedtls_aes_init(&aes);
+    mbedtls_aes_setkey_enc(&aes, (const unsigned char*)key.data(), 128);
+    std::string expected(payload.size(), 0);
+    unsigned char stream_block[16];
+    size_t offset = 0;
+    mbedtls_aes_crypt_ctr(&aes, payload.size(), &offset, counter, stream_block,
+        (const unsigned char*)payload.data(), (unsigned char*)expected.data());
+    mbedtls_aes_free(&aes);
+    CHECK(first.substr(ENCRYPTED_UDP_HEADER_SIZE) == expected);
+}
+
+static void TestRoundTripBothDirections() {
+    auto client_udp = new LoopbackUdp();
+    auto server_udp = new LoopbackUdp();
+    client_udp->peer = server_udp;
+    server_udp->peer = client_udp;
+    EncryptedUdp client(client_udp, key, salt, EncryptedUdpRole::Client);
+    EncryptedUdp server(server_udp, key, salt, EncryptedUdpRole::Server);
+    CHECK(client.Connect("host", 1));
+    CHECK(server.Connect("host", 2));
+
+    std::vector<std::string> server_received;
+    server.OnMessage([&server_received](const std::string& data) {
+        server_received.push_back(data);
+    });
+    std::vector<std::string> client_received;
+    client.OnMessageBuffer([&client_received](DatagramBuffer buffer) {
+        client_received.emplace_back(buffer.data(), buffer.size());
+    });
+
+    std::string large(1200, 'x');
+    for (size_t i = 0; i < large.size(); i++) {
+        large[i] = (char)i;
+    }
+    client.Send("uplink");
+    client.Send(large);
+    server.Send("downlink");
+    server.Send("");
+    CHECK((server_received == std::vector<std::string>{"uplink", large}));
+    CHECK((client_received == std::vector<std::string>{"downlink", ""}));
+    CHECK_EQ(client.decrypt_failures(), 0u);
+    CHECK_EQ(server.decrypt_failures(), 0u);
+}
+
+static void TestSameRoleDoesNotDecrypt() {
+    auto first_udp = new LoopbackUdp();
+    auto second_udp = new LoopbackUdp();
+    first_udp->peer = second_udp;
+    EncryptedUdp first(first_udp, key, salt, EncryptedUdpRole::Client);
+    EncryptedUdp second(second_udp, key, salt, EncryptedUdpRole::Client);
+    first.Connect("host", 1);
+    std::string received;
+    second.OnMessage([&received](const std::string& data) {
+        received = data;
+    });
+    // 方向位不同，两端角色相同时得到的是乱码
+    first.Send("same role");
+    CHECK_EQ(received.size(), 9u);
+    CHECK(received != "same role");
+}
+
+static void TestShortDatagramCounted() {
+    auto udp = new LoopbackUdp();
+    EncryptedUdp encrypted(udp, key, salt);
+    bool called = false;
+    encrypted.OnMessage([&called](const std::string& data) {
+        called = true;
+    });
+    udp->Deliver("short");
+    CHECK(!called);
+    CHECK_EQ(encrypted.decrypt_failures(), 1u);
+}
+
+static void TestInvalidKeyRejected() {
+    EncryptedUdp encrypted(new LoopbackUdp(), "short key", salt);
+    CHECK(!encrypted.Connect("host", 1));
+}
+
+int main() {
+    TestHostAesMatchesSp80038a();
+    TestWireFormat();
+    TestRoundTripBothDirections();
+    TestSameRoleDoesNotDecrypt();
+    TestShortDatagramCounted();
+    TestInvalidKeyRejected();
+    printf("encrypted_udp: OK\n");
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "jitter_buffer.h"
+#include "test_util.h"
+
+#include <esp_timer.h>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define FRAME_US 20000
+
+static std::shared_ptr<DatagramPool> pool = DatagramPool::Create(64, 8);
+
+static void PushAt(JitterBuffer& jitter_buffer, uint16_t sequence, int64_t time_us) {
+    host_timer_set_time(time_us);
+    auto buffer = pool->Acquire();
+    CHECK(buffer);
+    memcpy(buffer.data(), &sequence, sizeof(sequence));
+    buffer.set_size(sizeof(sequence));
+    jitter_buffer.Push(sequence, std::move(buffer));
+}
+
+// 每帧调用一次 Pop，返回播放出的序号，缺帧记为 -1
+static std::vector<int> PopAll(JitterBuffer& jitter_buffer, int64_t start_us, int frames) {
+    std::vector<int> played;
+    for (int i = 0; i < frames; i++) {
+        host_timer_set_time(start_us + (int64_t)i * FRAME_US);
+        DatagramBuffer buffer;
+        if (jitter_buffer.Pop(buffer)) {
+            uint16_t sequence;
+            memcpy(&sequence, buffer.data(), sizeof(sequence));
+            played.push_back(sequence);
+        } else {
+            played.push_back(-1);
+        }
+    }
+    return played;
+}
+
+static void TestReorder() {
+    JitterBuffer jitter_buffer(20, 120, 600, 16);
+    const uint16_t order[] = {0, 2, 1, 3, 5, 4};
+    for (int i = 0; i < 6; i++) {
+        PushAt(jitter_buffer, order[i], 1000000 + i * FRAME_US);
+    }
+    auto played = PopAll(jitter_buffer, 1000000 + 6 * FRAME_US, 6);
+    CHECK((played == std::vector<int>{0, 1, 2, 3, 4, 5}));
+    auto stats = jitter_buffer.GetStats();
+    CHECK_EQ(stats.lost, 0u);
+    CHECK_EQ(stats.concealed, 0u);
+    CHECK_EQ(stats.played, 6u);
+}
+
+static void TestLossCountedOnce() {
+    JitterBuffer jitter_buffer(20, 120, 600, 16);
+    const uint16_t sequences[] = {0, 1, 3, 6, 7};
+    for (auto sequence : sequences) {
+        PushAt(jitter_buffer, sequence, 1000000 + sequence * FRAME_US);
+    }
+    auto played = PopAll(jitter_buffer, 1000000 + 8 * FRAME_US, 8);
+    CHECK((played == std::vector<int>{0, 1, -1, 3, -1, -1, 6, 7}));
+    auto stats = jitter_buffer.GetStats();
+    CHECK_EQ(stats.lost, 3u);
+    CHECK_EQ(stats.concealed, 3u);
+
+    // 已经按缺帧处理的包迟到时记为 late；按 RFC 3550 它不再算作网络丢包，补偿次数不变
+    PushAt(jitter_buffer, 2, 1000000 + 16 * FRAME_US);
+    stats = jitter_buffer.GetStats();
+    CHECK_EQ(stats.late, 1u);
+    CHECK_EQ(stats.lost, 2u);
+    CHECK_EQ(stats.concealed, 3u);
+}
+
+static void TestSkipOverGapCountsLossOnce() {
+    // 积压过多时跳帧，跳过的位置恰好缺包时只算一次丢包
+    JitterBuffer jitter_buffer(20, 20, 600, 32);
+    PushAt(jitter_buffer, 0, 1000000);
+    for (uint16_t sequence = 2; sequence < 12; sequence++) {
+        PushAt(jitter_buffer, sequence, 1000000);
+    }
+    PopAll(jitter_buffer, 1000000 + FRAME_US, 12);
+    auto stats = jitter_buffer.GetStats();
+    CHECK_EQ(stats.lost, 1u);
+    CHECK(stats.discarded > 0);
+    CHECK_EQ(stats.played + stats.discarded, 11u);
+}
+
+static void TestDuplicateAndWrapAround() {
+    JitterBuffer jitter_buffer(20, 120, 600, 16);
+    const uint16_t sequences[] = {65534, 65535, 65535, 0, 1};
+    for (int i = 0; i < 5; i++) {
+        PushAt(jitter_buffer, sequences[i], 1000000 + i * FRAME_US);
+    }
+    auto played = PopAll(jitter_buffer, 1000000 + 6 * FRAME_US, 4);
+    CHECK((played == std::vector<int>{65534, 65535, 0, 1}));
+    auto stats = jitter_buffer.GetStats();
+    CHECK_EQ(stats.duplicate, 1u);
+    CHECK_EQ(stats.lost, 0u);
+}
+
+static void TestJitterEstimate() {
+    JitterBuffer jitter_buffer(20, 20, 600, 64);
+    // 奇数包晚到 10ms：相邻两包传输时间之差恒为 10ms
+    double reference_us = 0;
+    for (uint16_t sequence = 0; sequence < 200; sequence++) {
+        int64_t delay = (sequence % 2) ? 10000 : 0;
+        PushAt(jitter_buffer, sequence, 1000000 + sequence * FRAME_US + delay);
+        if (sequence > 0) {
+            // RFC 3550 6.4.1：J += (|D| - J) / 16
+            reference_us += (10000 - reference_us) / 16;
+        }
+        DatagramBuffer buffer;
+        jitter_buffer.Pop(buffer);
+    }
+    auto stats = jitter_buffer.GetStats();
+    CHECK(std::abs((int)stats.jitter_ms - (int)(reference_us / 1000)) <= 1);
+    CHECK(stats.jitter_ms >= 9);
+    // 目标延迟 = 一帧 + 3 倍抖动
+    CHECK(std::abs((int)stats.target_delay_ms - (int)(20 + 3 * stats.jitter_ms)) <= 3);
+}
+
+static void TestConstantDelayHasNoJitter() {
+    JitterBuffer jitter_buffer(20, 20, 600, 64);
+    for (uint16_t sequence = 0; sequence < 50; sequence++) {
+        PushAt(jitter_buffer, sequence, 1000000 + sequence * FRAME_US + 35000);
+        DatagramBuffer buffer;
+        jitter_buffer.Pop(buffer);
+    }
+    CHECK_EQ(jitter_buffer.GetStats().jitter_ms, 0u);
+}
+
+int main() {
+    TestReorder();
+    TestLossCountedOnce();
+    TestSkipOverGapCountsLossOnce();
+    TestDuplicateAndWrapAround();
+    TestJitterEstimate();
+    TestConstantDelayHasNoJitter();
+    printf("jitter_buffer: OK\n");
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include "mqtt_batch_publisher.h"
+#include "fake_mqtt.h"
+#include "test_util.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::vector<std::string> UnpackAll(const std::vector<FakeMqtt::Message>& messages) {
+    std::vector<std::string> records;
+    for (auto& message : messages) {
+        CHECK(MqttBatchPublisher::Unpack(message.payload, [&records](const char* data, size_t length) {
+            records.emplace_back(data, length);
+        }));
+    }
+    return records;
+}
+
+static void TestVarintFraming() {
+    FakeMqtt mqtt;
+    mqtt.Connect("broker", 1883, "id", "", "");
+    MqttBatchPublisher publisher(mqtt, 1024, 60000);
+    // 0、127 用一个字节的长度前缀，128、300 用两个字节
+    std::vector<std::string> records = {"", std::string(127, 'a'), std::string(128, 'b'), std::string(300, 'c')};
+    for (auto& record : records) {
+        CHECK(publisher.Add("t", record));
+    }
+    CHECK(publisher.Flush("t"));
+
+    auto published = mqtt.GetPublished();
+    CHECK_EQ(published.size(), 1u);
+    auto& payload = published[0].payload;
+    CHECK_EQ(payload.size(), 1 + 0 + 1 + 127 + 2 + 128 + 2 + 300u);
+    CHECK_EQ((uint8_t)payload[0], 0x00);
+    CHECK_EQ((uint8_t)payload[1], 0x7F);
+    CHECK_EQ((uint8_t)payload[129], 0x80);
+    CHECK_EQ((uint8_t)payload[130], 0x01);
+    CHECK(UnpackAll(published) == records);
+}
+
+static void TestUnpackRejectsMalformed() {
+    auto ignore = [](const char* data, size_t length) {};
+    // 长度超出剩余数据
+    CHECK(!MqttBatchPublisher::Unpack(std::string("\x05" "abc", 4), ignore));
+    // varint 没有结束
+    CHECK(!MqttBatchPublisher::Unpack(std::string("\x80\x80", 2), ignore));
+    // varint 超过 32 位
+    CHECK(!MqttBatchPublisher::Unpack(std::string("\xFF\xFF\xFF\xFF\xFF\x01", 6), ignore));
+    CHECK(MqttBatchPublisher::Unpack("", ignore));
+}
+
+static void TestSizeThresholdSeals() {
+    FakeMqtt mqtt;
+    mqtt.Connect("broker", 1883, "id", "", "");
+    MqttBatchPublisher publisher(mqtt, 16, 60000);
+    for (int i = 0; i < 6; i++) {
+        CHECK(publisher.Add("t", "rec" + std::to_string(i)));
+    }
+    // 每条记录连同前缀 5 字节，预留最长前缀后 16 字节的批次只放 2 条，最后一批等待期限
+    auto published = mqtt.GetPublished();
+    CHECK_EQ(published.size(), 2u);
+    CHECK_EQ(UnpackAll(published).size(), 4u);
+    CHECK(publisher.Flush());
+    CHECK_EQ(UnpackAll(mqtt.GetPublished()).size(), 6u);
+}
+
+static void TestFailedFlushKeepsRecords() {
+    FakeMqtt mqtt;
+    MqttBatchPublisher publisher(mqtt, 16, 50);
+    // 没有连接时发布失败，但记录已经被接受，Add 仍返回 true
+    for (int i = 0; i < 6; i++) {
+        CHECK(publisher.Add("t", "rec" + std::to_string(i)));
+    }
+    CHECK(mqtt.GetPublished().empty());
+    CHECK(publisher.GetStats().publish_failures > 0);
+
+    mqtt.Connect("broker", 1883, "id", "", "");
+    std::vector<std::string> records;
+    for (int i = 0; i < 100 && records.size() < 6; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        records = UnpackAll(mqtt.GetPublished());
+    }
+    // 定时线程按原顺序重发，没有重复
+    CHECK_EQ(records.size(), 6u);
+    for (int i = 0; i < 6; i++) {
+        CHECK_EQ(records[i], "rec" + std::to_string(i));
+    }
+    CHECK_EQ(publisher.GetStats().dropped_batches, 0u);
+}
+
+int main() {
+    TestVarintFraming();
+    TestUnpackRejectsMalformed();
+    TestSizeThresholdSeals();
+    TestFailedFlushKeepsRecords();
+    printf("mqtt_batch_publisher: OK\n");
+    return 0;
+}
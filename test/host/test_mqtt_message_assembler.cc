@@ -0,0 +1,59 @@
+#include "mqtt_message_assembler.h"
+#include "test_util.h"
+
+#include <string>
+
+static void TestInterleavedMessages() {
+    MqttMessageAssembler assembler;
+    auto first = assembler.Get("1", "a", 6);
+    CHECK(first != nullptr);
+    CHECK(first->payload.capacity() >= 6);
+    first->payload.append("abc");
+
+    // 另一条消息的分段插在中间，互不影响
+    auto second = assembler.Get("2", "b", 4);
+    CHECK(second != nullptr);
+    second->payload.append("wx");
+
+    first = assembler.Get("1", "a", 6);
+    first->payload.append("def");
+    CHECK_EQ(first->topic, std::string("a"));
+    CHECK_EQ(first->payload, std::string("abcdef"));
+    CHECK_EQ(first->payload.size(), first->total_length);
+    assembler.Remove("1");
+
+    second = assembler.Get("2", "b", 4);
+    second->payload.append("yz");
+    CHECK_EQ(second->payload, std::string("wxyz"));
+}
+
+static void TestRejectsOversizedMessage() {
+    MqttMessageAssembler assembler;
+    assembler.SetMaxMessageSize(8);
+    CHECK(assembler.Get("1", "a", 9) == nullptr);
+    CHECK(assembler.Get("1", "a", 8) != nullptr);
+}
+
+static void TestEvictsOldestPartial() {
+    MqttMessageAssembler assembler;
+    for (int i = 0; i < MQTT_MAX_PARTIAL_MESSAGES; i++) {
+        auto message = assembler.Get(std::to_string(i), "t", 4);
+        message->payload = std::to_string(i);
+    }
+    // 超过上限时丢弃最早开始的那条
+    auto message = assembler.Get("new", "t", 4);
+    CHECK(message != nullptr);
+    CHECK(message->payload.empty());
+    message = assembler.Get("0", "t", 4);
+    CHECK(message->payload.empty());
+    message = assembler.Get("2", "t", 4);
+    CHECK_EQ(message->payload, std::string("2"));
+}
+
+int main() {
+    TestInterleavedMessages();
+    TestRejectsOversizedMessage();
+    TestEvictsOldestPartial();
+    printf("mqtt_message_assembler: OK\n");
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "mqtt_topic_trie.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static MqttTopicTrie trie;
+static std::vector<std::string> matched;
+
+static MqttMessageHandler Handler(const char* name) {
+    return [name](const std::string&, const std::string&) {
+        matched.push_back(name);
+    };
+}
+
+static std::string Match(const std::string& topic) {
+    std::vector<MqttMessageHandler> handlers;
+    trie.Match(topic, handlers);
+    matched.clear();
+    for (auto& handler : handlers) {
+        handler(topic, "");
+    }
+    std::sort(matched.begin(), matched.end());
+    std::string result;
+    for (auto& name : matched) {
+        result += result.empty() ? name : "," + name;
+    }
+    return result;
+}
+
+static void TestWildcards() {
+    trie.Insert("a/b", Handler("a/b"));
+    trie.Insert("a/+", Handler("a/+"));
+    trie.Insert("a/#", Handler("a/#"));
+    trie.Insert("#", Handler("#"));
+    trie.Insert("+/+/c", Handler("+/+/c"));
+    CHECK_EQ(trie.size(), 5u);
+
+    CHECK_EQ(Match("a/b"), std::string("#,a/#,a/+,a/b"));
+    // a/# 也匹配父层级本身
+    CHECK_EQ(Match("a"), std::string("#,a/#"));
+    CHECK_EQ(Match("x/y/c"), std::string("#,+/+/c"));
+    CHECK_EQ(Match("a/b/c"), std::string("#,+/+/c,a/#"));
+    // 空层级也是一个层级
+    CHECK_EQ(Match("a//c"), std::string("#,+/+/c,a/#"));
+    CHECK_EQ(Match("b"), std::string("#"));
+}
+
+static void TestSystemTopicsSkipLeadingWildcards() {
+    trie.Insert("$SYS/#", Handler("$SYS/#"));
+    CHECK_EQ(Match("$SYS/uptime"), std::string("$SYS/#"));
+    trie.Remove("$SYS/#");
+}
+
+static void TestReplaceAndRemove() {
+    trie.Insert("a/b", Handler("a/b v2"));
+    CHECK_EQ(trie.size(), 5u);
+    CHECK_EQ(Match("a/b"), std::string("#,a/#,a/+,a/b v2"));
+
+    CHECK(trie.Remove("a/+"));
+    CHECK(!trie.Remove("a/+"));
+    CHECK(!trie.Remove("not/subscribed"));
+    CHECK_EQ(trie.size(), 4u);
+    CHECK_EQ(Match("a/x"), std::string("#,a/#"));
+
+    CHECK(trie.Remove("#"));
+    CHECK(trie.Remove("a/#"));
+    CHECK(trie.Remove("a/b"));
+    CHECK(trie.Remove("+/+/c"));
+    CHECK(trie.empty());
+    CHECK_EQ(Match("a/b"), std::string(""));
+}
+
+int main() {
+    TestWildcards();
+    TestSystemTopicsSkipLeadingWildcards();
+    TestReplaceAndRemove();
+    printf("mqtt_topic_trie: OK\n");
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include "store_forward_mqtt.h"
+#include "fake_mqtt.h"
+#include "test_util.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#define SPILL_PATH "test_store_forward_spill.bin"
+
+static void RemoveSpillFile() {
+    remove(SPILL_PATH);
+    remove(SPILL_PATH ".pos");
+}
+
+// 等待补发线程把消息发完
+static std::vector<FakeMqtt::Message> WaitPublished(FakeMqtt* mqtt, size_t count) {
+    for (int i = 0; i < 200 && mqtt->GetPublished().size() < count; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return mqtt->GetPublished();
+}
+
+static void TestQueuedWhileOffline() {
+    auto mqtt = new FakeMqtt();
+    StoreForwardMqtt store(mqtt, 4);
+    store.SetDrainInterval(1);
+    for (int i = 0; i < 3; i++) {
+        CHECK(store.Publish("t", std::to_string(i)));
+    }
+    CHECK_EQ(store.GetQueuedCount(), 3u);
+    CHECK(mqtt->GetPublished().empty());
+
+    store.Connect("broker", 1883, "id", "", "");
+    auto published = WaitPublished(mqtt, 3);
+    CHECK_EQ(published.size(), 3u);
+    for (int i = 0; i < 3; i++) {
+        CHECK_EQ(published[i].payload, std::to_string(i));
+    }
+}
+
+static void TestAlreadyConnectedClient() {
+    auto mqtt = new FakeMqtt();
+    mqtt->SetConnected(true);
+    StoreForwardMqtt store(mqtt, 4);
+    CHECK(store.Publish("t", "direct"));
+    CHECK_EQ(store.GetQueuedCount(), 0u);
+    CHECK_EQ(mqtt->GetPublished().size(), 1u);
+}
+
+static void TestMemoryOverflowDropsOldest() {
+    auto mqtt = new FakeMqtt();
+    StoreForwardMqtt store(mqtt, 2);
+    CHECK(store.Publish("t", "0"));
+    CHECK(store.Publish("t", "1"));
+    // 没有溢写文件时新消息仍然被接受，丢弃的是最早的一条
+    CHECK(store.Publish("t", "2"));
+    CHECK_EQ(store.GetQueuedCount(), 2u);
+    CHECK_EQ(store.GetDroppedCount(), 1u);
+}
+
+static void TestSpillFullReturnsFalse() {
+    RemoveSpillFile();
+    auto mqtt = new FakeMqtt();
+    StoreForwardMqtt store(mqtt, 1);
+    // 只够一条记录：11 字节头部 + 1 字节主题 + 1 字节内容
+    store.SetSpillFile(SPILL_PATH, 13);
+    CHECK(store.Publish("t", "0"));
+    CHECK(store.Publish("t", "1"));
+    CHECK(!store.Publish("t", "2"));
+    CHECK_EQ(store.GetDroppedCount(), 1u);
+    RemoveSpillFile();
+}
+
+static void TestSpillSurvivesRestart() {
+    RemoveSpillFile();
+    {
+        auto mqtt = new FakeMqtt();
+        StoreForwardMqtt store(mqtt, 2);
+        store.SetSpillFile(SPILL_PATH);
+        store.SetDrainInterval(1);
+        for (int i = 0; i < 6; i++) {
+            CHECK(store.Publish("t", std::to_string(i)));
+        }
+        // 只补发一部分就"断电"
+        mqtt->SetPublishLimit(3);
+        store.Connect("broker", 1883, "id", "", "");
+        CHECK_EQ(WaitPublished(mqtt, 3).size(), 3u);
+    }
+    {
+        auto mqtt = new FakeMqtt();
+        StoreForwardMqtt store(mqtt, 2);
+        store.SetSpillFile(SPILL_PATH);
+        store.SetDrainInterval(1);
+        store.Connect("broker", 1883, "id", "", "");
+        auto published = WaitPublished(mqtt, 4);
+        // 内存中的 0、1 不会重发；进度按批记录，没发完的一批（2、3）从头重发
+        CHECK_EQ(published.size(), 4u);
+        CHECK_EQ(published.front().payload, "2");
+        CHECK_EQ(published.back().payload, "5");
+    }
+    FILE* file = fopen(SPILL_PATH, "rb");
+    CHECK(file == nullptr);
+    RemoveSpillFile();
+}
+
+static void TestExpiryUsesUptime() {
+    auto mqtt = new FakeMqtt();
+    StoreForwardMqtt store(mqtt, 4);
+    store.SetDrainInterval(1);
+    CHECK(store.Publish("t", "stale", 0, 1));
+    CHECK(store.Publish("t", "fresh", 0, 0));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    store.Connect("broker", 1883, "id", "", "");
+    auto published = WaitPublished(mqtt, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    published = mqtt->GetPublished();
+    CHECK_EQ(published.size(), 1u);
+    CHECK_EQ(published[0].payload, "fresh");
+    CHECK_EQ(store.GetDroppedCount(), 1u);
+}
+
+int main() {
+    TestQueuedWhileOffline();
+    TestAlreadyConnectedClient();
+    TestMemoryOverflowDropsOldest();
+    TestSpillFullReturnsFalse();
+    TestSpillSurvivesRestart();
+    TestExpiryUsesUptime();
+    printf("store_forward_mqtt: OK\n");
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include "udp_probe.h"
+#include "test_util.h"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class LoopbackEndpoint;
+
+// 探测端的 Udp：Send 交给回显端点，drop_every 模拟每 N 个包丢一个
+class LoopbackUdp : public Udp {
+public:
+    LoopbackEndpoint* endpoint = nullptr;
+    int drop_every = 0;
+
+    bool Connect(const std::string& host, int port) override {
+        connected_ = true;
+        return true;
+    }
+    void Disconnect() override { connected_ = false; }
+    int Send(const std::string& data) override;
+
+    void Deliver(const std::string& data) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            last_received_ = data;
+        }
+        if (message_callback_) {
+            message_callback_(data);
+        }
+    }
+    bool has_callback() const { return (bool)message_callback_; }
+    std::string last_received() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_received_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::string last_received_;
+    int sent_ = 0;
+};
+
+class LoopbackEndpoint : public UdpEndpoint {
+public:
+    LoopbackUdp* udp = nullptr;
+
+    bool Bind(int local_port = 0) override {
+        bound_ = true;
+        return true;
+    }
+    void Close() override { bound_ = false; }
+    int SendTo(const std::string& host, int port, const std::string& data) override {
+        CHECK_EQ(host, std::string("192.0.2.1"));
+        CHECK_EQ(port, 4000);
+        udp->Deliver(data);
+        return data.size();
+    }
+    void Deliver(const std::string& data) {
+        if (bound_ && message_callback_) {
+            message_callback_("192.0.2.1", 4000, data);
+        }
+    }
+    bool has_callback() const { return (bool)message_callback_; }
+};
+
+int LoopbackUdp::Send(const std::string& data) {
+    sent_++;
+    if (drop_every > 0 && sent_ % drop_every == 0) {
+        return data.size();
+    }
+    endpoint->Deliver(data);
+    return data.size();
+}
+
+static void Sleep(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static void TestProbeThroughEchoServer() {
+    LoopbackUdp udp;
+    LoopbackEndpoint endpoint;
+    udp.endpoint = &endpoint;
+    endpoint.udp = &udp;
+    udp.Connect("192.0.2.2", 4000);
+
+    UdpEchoServer server(endpoint);
+    CHECK(server.Start(4000));
+    {
+        UdpProbe probe(udp);
+        probe.Start(5, 64, 200);
+        Sleep(150);
+        probe.Stop();
+        Sleep(20);
+
+        // 最后一个探测包的回显可能在 Stop 之后才到
+        auto stats = probe.GetStats();
+        CHECK(stats.sent >= 5);
+        CHECK(stats.received + 1 >= stats.sent);
+        CHECK(stats.received <= stats.sent);
+        CHECK(server.echoed() >= stats.received);
+        CHECK(stats.loss_rate == 0);
+        CHECK(stats.rtt_min_us <= stats.rtt_p50_us);
+        CHECK(stats.rtt_p50_us <= stats.rtt_p95_us);
+        CHECK(stats.rtt_p95_us <= stats.rtt_max_us);
+
+        // Stop 之后迟到的回显不再计入统计
+        auto late = udp.last_received();
+        CHECK_EQ(late.size(), 64u);
+        udp.Deliver(late);
+        CHECK_EQ(probe.GetStats().received, stats.received);
+    }
+    // 析构时断开并清除回调
+    CHECK(!udp.connected());
+    CHECK(!udp.has_callback());
+
+    server.Stop();
+    CHECK(!endpoint.bound());
+    CHECK(!endpoint.has_callback());
+}
+
+static void TestProbeLoss() {
+    LoopbackUdp udp;
+    LoopbackEndpoint endpoint;
+    udp.endpoint = &endpoint;
+    endpoint.udp = &udp;
+    udp.drop_every = 4;
+    udp.Connect("192.0.2.2", 4000);
+
+    UdpEchoServer server(endpoint);
+    CHECK(server.Start(4000));
+    UdpProbe probe(udp);
+    probe.Start(5, UDP_PROBE_HEADER_SIZE, 30);
+    Sleep(200);
+    probe.Stop();
+    Sleep(50);
+
+    // 丢掉的探测包超时后计入丢包率
+    auto stats = probe.GetStats();
+    CHECK(stats.received < stats.sent);
+    CHECK(stats.loss_rate > 0.15f && stats.loss_rate < 0.35f);
+}
+
+static void TestEchoServerStopDropsLateDatagrams() {
+    LoopbackUdp udp;
+    LoopbackEndpoint endpoint;
+    endpoint.udp = &udp;
+    UdpEchoServer server(endpoint);
+    CHECK(server.Start(4000));
+    endpoint.Deliver("one");
+    Sleep(20);
+    CHECK_EQ(server.echoed(), 1u);
+
+    server.Stop();
+    endpoint.Deliver("two");
+    Sleep(20);
+    CHECK_EQ(server.echoed(), 1u);
+
+    // 可以重新启动
+    CHECK(server.Start(4000));
+    endpoint.Deliver("three");
+    Sleep(20);
+    CHECK_EQ(server.echoed(), 2u);
+}
+
+int main() {
+    TestProbeThroughEchoServer();
+    TestProbeLoss();
+    TestEchoServerStopDropsLateDatagrams();
+    printf("udp_probe: OK\n");
+    return 0;
+}
@@ -0,0 +1,24 @@
+#ifndef HOST_TEST_UTIL_H
+#define HOST_TEST_UTIL_H
+
+#include <cstdio>
+#include <cstdlib>
+
+// 主机测试不依赖测试框架，失败时打印位置并以非零状态退出
+#define CHECK(condition) do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1); \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+        auto actual_value = (actual); \
+        auto expected_value = (expected); \
+        if (!(actual_value == expected_value)) { \
+            fprintf(stderr, "%s:%d: CHECK_EQ failed: %s != %s\n", __FILE__, __LINE__, #actual, #expected); \
+            exit(1); \
+        } \
+    } while (0)
+
+#endif // HOST_TEST_UTIL_H
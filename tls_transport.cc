@@ -1,12 +1,59 @@
 #include "tls_transport.h"
+#include "dns_cache.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <esp_log.h>
 #include <esp_crt_bundle.h>
+#include <esp_timer.h>
 #include <cstring>
+#include <cerrno>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
 
 #define TAG "TlsTransport"
 
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+// 按 host:port 保存的 TLS 会话，重连时用于会话恢复以省去完整握手
+static std::mutex session_mutex;
+static std::map<std::string, esp_tls_client_session_t*> sessions;
+
+// 取出会话的所有权，避免握手期间被其他连接释放
+static esp_tls_client_session_t* TakeSession(const std::string& key) {
+    std::lock_guard<std::mutex> lock(session_mutex);
+    auto it = sessions.find(key);
+    if (it == sessions.end()) {
+        return nullptr;
+    }
+    auto session = it->second;
+    sessions.erase(it);
+    return session;
+}
+
+static void StoreSession(const std::string& key, esp_tls_client_session_t* session) {
+    std::lock_guard<std::mutex> lock(session_mutex);
+    auto& slot = sessions[key];
+    if (slot != nullptr) {
+        esp_tls_free_client_session(slot);
+    }
+    slot = session;
+}
+#endif
+
+// 区分 TCP 连接失败（地址可能已失效）和 TLS 握手失败
+static bool IsConnectError(esp_tls_t* tls) {
+    esp_tls_error_handle_t error_handle = nullptr;
+    if (esp_tls_get_error_handle(tls, &error_handle) != ESP_OK || error_handle == nullptr) {
+        return false;
+    }
+    esp_err_t err = esp_tls_get_and_clear_last_error(error_handle, nullptr, nullptr);
+    return err == ESP_ERR_ESP_TLS_FAILED_CONNECT_TO_HOST || err == ESP_ERR_ESP_TLS_CONNECTION_TIMEOUT
+        || err == ESP_ERR_ESP_TLS_CANNOT_CREATE_SOCKET;
+}
+
 TlsTransport::TlsTransport() {
     tls_client_ = esp_tls_init();
 }
@@ -18,19 +65,102 @@ TlsTransport::~TlsTransport() {
 }
 
 bool TlsTransport::Connect(const char* host, int port) {
+    if (connected_) {
+        Disconnect();
+    }
+    // 使用缓存的地址连接（IPv4 和 IPv6），证书校验和 SNI 仍使用原主机名
+    std::vector<struct sockaddr_storage> addrs;
+    if (!DnsCache::GetInstance().Resolve(host, addrs)) {
+        ESP_LOGE(TAG, "Failed to resolve %s", host);
+        return false;
+    }
+
     esp_tls_cfg_t cfg = {};
     cfg.crt_bundle_attach = esp_crt_bundle_attach;
+    cfg.common_name = host;
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    std::string session_key = std::string(host) + ":" + std::to_string(port);
+    esp_tls_client_session_t* session = TakeSession(session_key);
+    cfg.client_session = session;
+    session_offered_ = session != nullptr;
+#else
+    session_offered_ = false;
+#endif
+
+    // 依次尝试每个地址，只有 TCP 连接失败时才换下一个地址；握手失败与地址无关
+    int ret = 0;
+    bool address_failed = false;
+    for (auto& addr : addrs) {
+        char ip[INET6_ADDRSTRLEN];
+        if (addr.ss_family == AF_INET6) {
+            inet_ntop(AF_INET6, &((struct sockaddr_in6*)&addr)->sin6_addr, ip, sizeof(ip));
+        } else {
+            inet_ntop(AF_INET, &((struct sockaddr_in*)&addr)->sin_addr, ip, sizeof(ip));
+        }
+        // Disconnect 或上一个地址失败后需要重新创建
+        if (tls_client_ == nullptr) {
+            tls_client_ = esp_tls_init();
+            if (tls_client_ == nullptr) {
+                ESP_LOGE(TAG, "Failed to initialize TLS client");
+                break;
+            }
+        }
+
+        int64_t start = esp_timer_get_time();
+        ret = esp_tls_conn_new_sync(ip, strlen(ip), port, &cfg, tls_client_);
+        last_handshake_us_ = esp_timer_get_time() - start;
+        if (ret == 1) {
+            break;
+        }
+
+        address_failed = IsConnectError(tls_client_);
+        esp_tls_conn_destroy(tls_client_);
+        tls_client_ = nullptr;
+        if (!address_failed) {
+            break;
+        }
+        ESP_LOGW(TAG, "Failed to connect to %s (%s)", host, ip);
+    }
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    // 握手时会话已复制到 SSL 上下文，成功后保存服务器下发的新会话
+    if (session != nullptr) {
+        esp_tls_free_client_session(session);
+    }
+    if (ret == 1) {
+        auto new_session = esp_tls_get_client_session(tls_client_);
+        if (new_session != nullptr) {
+            StoreSession(session_key, new_session);
+        }
+    }
+#endif
 
-    int ret = esp_tls_conn_new_sync(host, strlen(host), port, &cfg, tls_client_);
     if (ret != 1) {
         ESP_LOGE(TAG, "Failed to connect to %s:%d", host, port);
+        if (address_failed) {
+            // 所有地址都连不上，地址可能已经变化，下次重新解析
+            DnsCache::GetInstance().Invalidate(host);
+        }
         return false;
     }
 
+    ESP_LOGI(TAG, "Connected to %s:%d, handshake %d ms%s", host, port, (int)(last_handshake_us_ / 1000),
+        session_offered_ ? " (session resumption offered)" : "");
     connected_ = true;
     return true;
 }
 
+void TlsTransport::ClearSessionCache() {
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    std::lock_guard<std::mutex> lock(session_mutex);
+    for (auto& session : sessions) {
+        esp_tls_free_client_session(session.second);
+    }
+    sessions.clear();
+#endif
+}
+
 void TlsTransport::Disconnect() {
     if (tls_client_) {
         esp_tls_conn_destroy(tls_client_);
@@ -39,29 +169,82 @@ void TlsTransport::Disconnect() {
     connected_ = false;
 }
 
-int TlsTransport::Send(const char* data, size_t length) {
-    int ret = esp_tls_conn_write(tls_client_, data, length);
-    if (ret == ESP_TLS_ERR_SSL_WANT_WRITE) {
-        vTaskDelay(1);
-        return 0;
+void TlsTransport::SetTimeouts(int send_timeout_ms, int receive_timeout_ms) {
+    send_timeout_ms_ = send_timeout_ms;
+    receive_timeout_ms_ = receive_timeout_ms;
+}
+
+int TlsTransport::WaitSocket(short events, int timeout_ms) {
+    int fd = -1;
+    if (esp_tls_get_conn_sockfd(tls_client_, &fd) != ESP_OK || fd < 0) {
+        return -1;
     }
-    if (ret <= 0) {
-        connected_ = false;
-        ESP_LOGE(TAG, "TLS发送失败: %d", ret);
+    struct pollfd pfd = {
+        .fd = fd,
+        .events = events,
+        .revents = 0,
+    };
+    while (true) {
+        int ret = poll(&pfd, 1, timeout_ms);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret < 0) {
+            ESP_LOGE(TAG, "Poll failed: errno=%d", errno);
+            return -1;
+        }
+        // 挂断时 revents 也不为 0，由随后的读写得到具体错误
+        return ret;
     }
-    return ret;
 }
 
-int TlsTransport::Receive(char* buffer, size_t bufferSize) {
-    int ret = 0;
-    do {
-        ret = esp_tls_conn_read(tls_client_, buffer, bufferSize);
-    } while (ret == ESP_TLS_ERR_SSL_WANT_READ);
+int TlsTransport::Send(const char* data, size_t length) {
+    if (!tls_client_) return -1;
+    while (true) {
+        int ret = esp_tls_conn_write(tls_client_, data, length);
+        if (ret == ESP_TLS_ERR_SSL_WANT_WRITE || ret == ESP_TLS_ERR_SSL_WANT_READ) {
+            // 发送缓冲区满，阻塞等待套接字可写而不是空转
+            short events = ret == ESP_TLS_ERR_SSL_WANT_WRITE ? POLLOUT : POLLIN;
+            if (WaitSocket(events, send_timeout_ms_) <= 0) {
+                ESP_LOGE(TAG, "TLS发送超时");
+                connected_ = false;
+                return -1;
+            }
+            continue;
+        }
+        if (ret <= 0) {
+            connected_ = false;
+            ESP_LOGE(TAG, "TLS发送失败: %d", ret);
+        }
+        return ret;
+    }
+}
 
-    if (ret == 0) {
-        connected_ = false;
-    } else if (ret < 0) {
-        ESP_LOGE(TAG, "TLS读取失败: %d", ret);
+int TlsTransport::Receive(char* buffer, size_t bufferSize) {
+    if (!tls_client_) return -1;
+    while (true) {
+        // 已解密的数据留在 mbedtls 中，此时套接字不一定可读
+        if (esp_tls_get_bytes_avail(tls_client_) <= 0) {
+            int ready = WaitSocket(POLLIN, receive_timeout_ms_);
+            if (ready < 0) {
+                connected_ = false;
+                return -1;
+            }
+            if (ready == 0) {
+                // 超时：没有数据但连接仍然有效
+                return TRANSPORT_RECEIVE_TIMEOUT;
+            }
+        }
+        int ret = esp_tls_conn_read(tls_client_, buffer, bufferSize);
+        if (ret == ESP_TLS_ERR_SSL_WANT_READ || ret == ESP_TLS_ERR_SSL_WANT_WRITE) {
+            // 只收到了 TLS 记录的一部分
+            continue;
+        }
+        if (ret == 0) {
+            connected_ = false;
+        } else if (ret < 0) {
+            ESP_LOGE(TAG, "TLS读取失败: %d", ret);
+        }
+        return ret;
     }
-    return ret;
 }
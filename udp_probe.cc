@@ -0,0 +1,264 @@
+#include "udp_probe.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <vector>
+
+static const char *TAG = "UdpProbe";
+
+static void WriteUint32(char* p, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = value >> (24 - 8 * i);
+    }
+}
+
+static uint32_t ReadUint32(const char* p) {
+    const uint8_t* u = (const uint8_t*)p;
+    return ((uint32_t)u[0] << 24) | (u[1] << 16) | (u[2] << 8) | u[3];
+}
+
+UdpProbe::UdpProbe(Udp& udp) : udp_(udp) {
+    event_group_handle_ = xEventGroupCreate();
+    for (auto& slot : slots_) {
+        slot.send_time_us = 0;
+        slot.rtt_us = -1;
+    }
+}
+
+UdpProbe::~UdpProbe() {
+    Stop();
+    // 回调捕获了 this：先断开让接收路径停止，再清除回调
+    if (callback_installed_) {
+        udp_.Disconnect();
+        udp_.OnMessage(nullptr);
+    }
+    vEventGroupDelete(event_group_handle_);
+}
+
+void UdpProbe::Start(int interval_ms, size_t packet_size, int timeout_ms) {
+    Stop();
+    interval_ms_ = interval_ms > 0 ? interval_ms : UDP_PROBE_DEFAULT_INTERVAL_MS;
+    packet_size_ = std::max(packet_size, (size_t)UDP_PROBE_HEADER_SIZE);
+    timeout_us_ = timeout_ms * 1000LL;
+
+    // 接收任务可能正在调用回调，运行期间不替换，只切换 active_
+    if (!callback_installed_) {
+        udp_.OnMessage([this](const std::string& data) {
+            HandleEcho(data);
+        });
+        callback_installed_ = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ = true;
+    }
+
+    stopping_ = false;
+    xEventGroupClearBits(event_group_handle_, UDP_PROBE_TASK_EXIT);
+    auto ret = xTaskCreate([](void* arg) {
+        auto probe = (UdpProbe*)arg;
+        probe->ProbeTask();
+        xEventGroupSetBits(probe->event_group_handle_, UDP_PROBE_TASK_EXIT);
+        vTaskDelete(NULL);
+    }, "udp_probe", 3072, this, 3, &probe_task_handle_);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create probe task");
+        probe_task_handle_ = nullptr;
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ = false;
+    }
+}
+
+void UdpProbe::Stop() {
+    if (probe_task_handle_ != nullptr) {
+        stopping_ = true;
+        xEventGroupWaitBits(event_group_handle_, UDP_PROBE_TASK_EXIT, pdTRUE, pdFALSE, portMAX_DELAY);
+        probe_task_handle_ = nullptr;
+    }
+    // 正在执行的 HandleEcho 持有 mutex_，拿到锁后迟到的回显不再计入统计
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_ = false;
+}
+
+void UdpProbe::ProbeTask() {
+    std::string packet(packet_size_, '\0');
+    WriteUint32(packet.data(), UDP_PROBE_MAGIC);
+
+    while (!stopping_) {
+        int64_t now = esp_timer_get_time();
+        uint32_t sequence;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            sequence = next_sequence_++;
+            auto& slot = slots_[sequence % UDP_PROBE_WINDOW];
+            slot.sequence = sequence;
+            slot.send_time_us = now;
+            slot.rtt_us = -1;
+            sent_++;
+        }
+        WriteUint32(packet.data() + 4, sequence);
+        WriteUint32(packet.data() + 8, (uint64_t)now >> 32);
+        WriteUint32(packet.data() + 12, (uint32_t)now);
+        if (udp_.Send(packet) < 0) {
+            ESP_LOGW(TAG, "Failed to send probe %lu", (unsigned long)sequence);
+        }
+        vTaskDelay(pdMS_TO_TICKS(interval_ms_));
+    }
+}
+
+void UdpProbe::HandleEcho(const std::string& data) {
+    if (data.size() < UDP_PROBE_HEADER_SIZE || ReadUint32(data.data()) != UDP_PROBE_MAGIC) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    uint32_t sequence = ReadUint32(data.data() + 4);
+    int64_t send_time = ((int64_t)ReadUint32(data.data() + 8) << 32) | ReadUint32(data.data() + 12);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!active_) {
+        return;
+    }
+    auto& slot = slots_[sequence % UDP_PROBE_WINDOW];
+    // 槽位已被更新的探测包复用，或是重复的回显
+    if (slot.sequence != sequence || slot.send_time_us != send_time || slot.rtt_us >= 0) {
+        return;
+    }
+    int64_t rtt = now - send_time;
+    if (rtt > timeout_us_) {
+        return;
+    }
+    slot.rtt_us = rtt;
+    received_++;
+    if (last_rtt_us_ >= 0) {
+        int64_t d = std::abs(rtt - last_rtt_us_);
+        jitter_us_x16_ += d - (jitter_us_x16_ >> 4);
+    }
+    last_rtt_us_ = rtt;
+}
+
+UdpProbeStats UdpProbe::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    UdpProbeStats stats = {};
+    stats.sent = sent_;
+    stats.received = received_;
+    stats.jitter_us = jitter_us_x16_ >> 4;
+
+    int64_t now = esp_timer_get_time();
+    std::vector<uint32_t> rtts;
+    rtts.reserve(UDP_PROBE_WINDOW);
+    uint32_t lost = 0;
+    for (auto& slot : slots_) {
+        if (slot.send_time_us == 0) {
+            continue;
+        }
+        if (slot.rtt_us >= 0) {
+            rtts.push_back(slot.rtt_us);
+        } else if (now - slot.send_time_us > timeout_us_) {
+            lost++;
+        }
+    }
+
+    size_t total = rtts.size() + lost;
+    if (total > 0) {
+        stats.loss_rate = (float)lost / total;
+    }
+    if (!rtts.empty()) {
+        std::sort(rtts.begin(), rtts.end());
+        uint64_t sum = 0;
+        for (auto rtt : rtts) {
+            sum += rtt;
+        }
+        stats.rtt_min_us = rtts.front();
+        stats.rtt_max_us = rtts.back();
+        stats.rtt_avg_us = sum / rtts.size();
+        stats.rtt_p50_us = rtts[rtts.size() / 2];
+        stats.rtt_p95_us = rtts[std::min(rtts.size() - 1, rtts.size() * 95 / 100)];
+    }
+    return stats;
+}
+
+UdpEchoServer::UdpEchoServer(UdpEndpoint& endpoint) : endpoint_(endpoint) {
+    event_group_handle_ = xEventGroupCreate();
+}
+
+UdpEchoServer::~UdpEchoServer() {
+    Stop();
+    vEventGroupDelete(event_group_handle_);
+}
+
+bool UdpEchoServer::Start(int port) {
+    Stop();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+        queue_.clear();
+    }
+    xEventGroupClearBits(event_group_handle_, UDP_ECHO_TASK_EXIT);
+    auto ret = xTaskCreate([](void* arg) {
+        auto server = (UdpEchoServer*)arg;
+        server->EchoTask();
+        xEventGroupSetBits(server->event_group_handle_, UDP_ECHO_TASK_EXIT);
+        vTaskDelete(NULL);
+    }, "udp_echo", 4096, this, 4, &echo_task_handle_);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create echo task");
+        echo_task_handle_ = nullptr;
+        return false;
+    }
+
+    endpoint_.OnMessage([this](const std::string& host, int port, const std::string& data) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                return;
+            }
+            if (queue_.size() >= UDP_ECHO_QUEUE_DEPTH) {
+                dropped_++;
+                return;
+            }
+            queue_.push_back({host, port, data});
+        }
+        cv_.notify_one();
+    });
+    if (!endpoint_.Bind(port)) {
+        Stop();
+        return false;
+    }
+    return true;
+}
+
+void UdpEchoServer::Stop() {
+    {
+        // 接收回调在锁内检查 stopping_，之后到达的数据报不再入队
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    // Close 返回时接收路径已经停止，此时清除回调不会与之并发
+    endpoint_.Close();
+    endpoint_.OnMessage(nullptr);
+    if (echo_task_handle_ == nullptr) {
+        return;
+    }
+    xEventGroupWaitBits(event_group_handle_, UDP_ECHO_TASK_EXIT, pdTRUE, pdFALSE, portMAX_DELAY);
+    echo_task_handle_ = nullptr;
+}
+
+void UdpEchoServer::EchoTask() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) {
+            break;
+        }
+        Echo echo = std::move(queue_.front());
+        queue_.pop_front();
+
+        lock.unlock();
+        if (endpoint_.SendTo(echo.host, echo.port, echo.data) >= 0) {
+            echoed_++;
+        }
+        lock.lock();
+    }
+}
@@ -259,6 +259,9 @@ void WebSocket::ReceiveTask() {
 
     while (transport_->connected()) {
         int ret = transport_->Receive(buffer + buffer_offset, receive_buffer_size_ - buffer_offset);
+        if (ret == TRANSPORT_RECEIVE_TIMEOUT) {
+            continue;
+        }
         if (ret < 0) {
             if (on_error_) {
                 on_error_(ret);